@@ -0,0 +1,260 @@
+#ifndef VE281P1_EXTERNAL_SORT_HPP
+#define VE281P1_EXTERNAL_SORT_HPP
+
+#include "sort.hpp"
+#include <atomic>
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * External merge sort for files of fixed-size records that do not fit in memory.
+ *
+ * Phase 1 reads the input in chunks of half the memory budget, sorts each chunk in place with intro_sort
+ * while the next chunk is being read, and spills it as a sorted run to a temporary file.
+ * Phase 2 merges the runs with a k-way heap merge. Every run is read, and the output written,
+ * through two alternating blocks so the disk streams sequentially while the merge works on the other block.
+ * When the runs are too many for the budget to give each a reasonable block, they are merged in several passes.
+ */
+
+// smallest read/write block worth giving a run during the merge
+constexpr size_t EXTERNAL_SORT_MIN_BLOCK_BYTES = 1 << 16;
+
+inline std::FILE *open_record_file(const std::string &path, const char *mode) {
+    std::FILE *file = std::fopen(path.c_str(), mode);
+    if (!file) throw std::runtime_error("external_sort: can not open " + path);
+    std::setvbuf(file, nullptr, _IONBF, 0); // the readers and writers below do their own buffering
+    return file;
+}
+
+// closes a record file when its owner goes away, on every path out of a scope
+struct record_file_closer {
+    void operator()(std::FILE *file) const { std::fclose(file); }
+};
+
+typedef std::unique_ptr<std::FILE, record_file_closer> record_file;
+
+inline std::string make_run_path(const std::string &temp_directory) {
+    static std::atomic<unsigned long> counter{0};
+    static const unsigned long salt = std::random_device()();
+    return temp_directory + "/ve281_run_" + std::to_string(salt) + "_" + std::to_string(counter++) + ".tmp";
+}
+
+// sequential reader of a record file, the next block is read in the background while the current one is consumed
+template<typename T>
+class run_reader {
+    std::FILE *file;
+    std::vector<T> current;
+    std::vector<T> next;
+    size_t current_size = 0;
+    size_t position = 0;
+    bool last_block = false;
+    std::future<size_t> pending;
+
+    void prefetch() {
+        pending = std::async(std::launch::async, [this] {
+            return std::fread(next.data(), sizeof(T), next.size(), file);
+        });
+    }
+
+    void refill() {
+        position = 0;
+        current_size = 0;
+        if (last_block) return;
+        size_t count = pending.get();
+        // a short read is the end of the run only when it is not an error
+        if (count < next.size() && std::ferror(file)) throw std::runtime_error("external_sort: read failed");
+        std::swap(current, next);
+        current_size = count;
+        if (count < current.size()) last_block = true;
+        else prefetch();
+    }
+
+public:
+    run_reader(const std::string &path, size_t block) : file(open_record_file(path, "rb")), current(block), next(block) {
+        prefetch();
+        try {
+            refill();
+        }
+        catch (...) {
+            std::fclose(file);
+            throw;
+        }
+    }
+
+    run_reader(const run_reader &) = delete;
+
+    run_reader &operator=(const run_reader &) = delete;
+
+    ~run_reader() {
+        if (pending.valid()) pending.wait();
+        std::fclose(file);
+    }
+
+    bool empty() const { return position == current_size; }
+
+    const T &front() const { return current[position]; }
+
+    void pop() {
+        if (++position == current_size) refill();
+    }
+};
+
+// sequential writer of a record file, a full block is written in the background while the next one fills
+template<typename T>
+class run_writer {
+    std::FILE *file;
+    std::vector<T> filling;
+    std::vector<T> flushing;
+    size_t count = 0;
+    std::future<void> pending;
+
+    void flush() {
+        if (pending.valid()) pending.get();
+        std::swap(filling, flushing);
+        size_t size = count;
+        count = 0;
+        pending = std::async(std::launch::async, [this, size] {
+            if (std::fwrite(flushing.data(), sizeof(T), size, file) != size)
+                throw std::runtime_error("external_sort: write failed");
+        });
+    }
+
+public:
+    run_writer(const std::string &path, size_t block) : file(open_record_file(path, "wb")), filling(block), flushing(block) {}
+
+    run_writer(const run_writer &) = delete;
+
+    run_writer &operator=(const run_writer &) = delete;
+
+    ~run_writer() {
+        if (pending.valid()) pending.wait();
+        if (file) std::fclose(file);
+    }
+
+    void push(const T &record) {
+        filling[count++] = record;
+        if (count == filling.size()) flush();
+    }
+
+    // write what is left and close the file, errors of the background writes surface here
+    void close() {
+        if (count > 0) flush();
+        if (pending.valid()) pending.get();
+        int status = std::fclose(file);
+        file = nullptr;
+        if (status != 0) throw std::runtime_error("external_sort: close failed");
+    }
+};
+
+// k-way merge of sorted run files, ties are taken from the earlier run so the output is deterministic;
+// the runs come from intro_sort, so records that compare equal do not keep their input order
+template<typename T, typename Compare>
+void merge_runs(const std::vector<std::string> &runs, const std::string &output_path, size_t block, Compare comp) {
+    std::vector<std::unique_ptr<run_reader<T>>> readers;
+    for (auto &run: runs) readers.emplace_back(new run_reader<T>(run, block));
+    auto later = [&readers, &comp](size_t a, size_t b) {
+        const T &x = readers[a]->front();
+        const T &y = readers[b]->front();
+        if (comp(y, x)) return true;
+        return !comp(x, y) && b < a;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heap(later);
+    for (size_t i = 0; i < readers.size(); i++) {
+        if (!readers[i]->empty()) heap.push(i);
+    }
+    run_writer<T> writer(output_path, block);
+    while (!heap.empty()) {
+        size_t top = heap.top();
+        heap.pop();
+        writer.push(readers[top]->front());
+        readers[top]->pop();
+        if (!readers[top]->empty()) heap.push(top);
+    }
+    writer.close();
+}
+
+/**
+ * Sort the records of type T stored back to back in input_path into output_path
+ * using about memory_bytes of memory. Temporary runs are created in temp_directory and removed afterwards.
+ * T must be trivially copyable, it is read and written as raw bytes; an input whose size is not a multiple
+ * of sizeof(T) is rejected. The sort is not stable.
+ */
+template<typename T, typename Compare = std::less<T>>
+void external_sort(const std::string &input_path, const std::string &output_path, size_t memory_bytes,
+                   Compare comp = Compare(), const std::string &temp_directory = ".") {
+    static_assert(std::is_trivially_copyable<T>::value, "external_sort needs trivially copyable records");
+    size_t chunk = std::max<size_t>(1, memory_bytes / sizeof(T) / 2);
+    std::vector<std::string> runs;
+    std::vector<std::string> temporaries; // every run file ever created, removed at the end even on failure
+    auto new_run = [&temporaries, &temp_directory] {
+        temporaries.push_back(make_run_path(temp_directory));
+        return temporaries.back();
+    };
+    auto remove_runs = [&temporaries] {
+        for (auto &run: temporaries) std::remove(run.c_str());
+    };
+    try {
+        // phase 1: sorted runs, the next chunk is read while the current one is sorted and spilled
+        // declared before the buffers and the pending read, so it is closed after the read has finished
+        record_file input(open_record_file(input_path, "rb"));
+        std::vector<T> current(chunk);
+        std::vector<T> next(chunk);
+        // read in bytes, so a trailing partial record shows up as a remainder instead of vanishing
+        auto read_chunk = [&] {
+            return std::fread(next.data(), 1, chunk * sizeof(T), input.get());
+        };
+        std::future<size_t> pending = std::async(std::launch::async, read_chunk);
+        while (true) {
+            size_t bytes = pending.get();
+            if (bytes < chunk * sizeof(T) && std::ferror(input.get()))
+                throw std::runtime_error("external_sort: can not read " + input_path);
+            if (bytes % sizeof(T) != 0)
+                throw std::runtime_error("external_sort: " + input_path + " ends in a partial record");
+            size_t count = bytes / sizeof(T);
+            if (count == 0) break;
+            std::swap(current, next);
+            bool more = count == chunk;
+            if (more) pending = std::async(std::launch::async, read_chunk);
+            current.resize(count);
+            intro_sort(current, comp);
+            runs.push_back(new_run());
+            std::FILE *run = open_record_file(runs.back(), "wb");
+            size_t written = std::fwrite(current.data(), sizeof(T), count, run);
+            if (std::fclose(run) != 0 || written != count)
+                throw std::runtime_error("external_sort: can not spill run " + runs.back());
+            current.resize(chunk);
+            if (!more) break;
+        }
+        input.reset();
+
+        // phase 2: merge, each input run and the output get two blocks of the budget
+        size_t fan_in = std::max<size_t>(2, memory_bytes / (2 * EXTERNAL_SORT_MIN_BLOCK_BYTES) - 1);
+        while (runs.size() > fan_in) {
+            std::vector<std::string> merged;
+            for (size_t first = 0; first < runs.size(); first += fan_in) {
+                std::vector<std::string> group(runs.begin() + first, runs.begin() + std::min(first + fan_in, runs.size()));
+                size_t block = std::max<size_t>(1, memory_bytes / sizeof(T) / (2 * (group.size() + 1)));
+                merged.push_back(new_run());
+                merge_runs<T>(group, merged.back(), block, comp);
+                for (auto &run: group) std::remove(run.c_str());
+            }
+            runs.swap(merged);
+        }
+        size_t block = std::max<size_t>(1, memory_bytes / sizeof(T) / (2 * (runs.size() + 1)));
+        merge_runs<T>(runs, output_path, block, comp);
+    }
+    catch (...) {
+        remove_runs();
+        throw;
+    }
+    remove_runs();
+}
+
+#endif //VE281P1_EXTERNAL_SORT_HPP
@@ -0,0 +1,182 @@
+#ifndef VE281P1_GEOMETRY_HPP
+#define VE281P1_GEOMETRY_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * Exact orientation predicate for the hull code, for any integral or floating point coordinate type.
+ *
+ * The arithmetic is picked from the coordinate type so that no input can overflow or round the sign wrong:
+ * - integers of up to 16 bits: 64-bit products
+ * - 32-bit integers: 64-bit differences, 64-bit products when the differences fit 31 bits, 128-bit ones otherwise
+ * - 64-bit integers: the differences are kept as sign and 64-bit magnitude and compared as 128-bit products
+ * - float and double: Shewchuk's adaptive test, the plain double determinant when it is clearly away from zero,
+ *   an exact sum of the six products otherwise
+ */
+
+// a wide enough type to add or subtract two coordinates without overflow, used to rank extreme points
+template<typename T, typename Enable = void>
+struct geometry_wide {
+    typedef double type;
+};
+
+template<typename T>
+struct geometry_wide<T, typename std::enable_if<std::is_integral<T>::value && sizeof(T) <= 4>::type> {
+    typedef long long type;
+};
+
+template<typename T>
+struct geometry_wide<T, typename std::enable_if<std::is_integral<T>::value && (sizeof(T) > 4)>::type> {
+#ifdef __SIZEOF_INT128__
+    typedef __int128 type;
+#else
+    typedef long double type;
+#endif
+};
+
+template<typename T>
+using geometry_wide_t = typename geometry_wide<T>::type;
+
+// -1, 0 or 1 for a < b, a == b or a > b
+template<typename T>
+int geometry_compare(T a, T b) {
+    return (a > b) - (a < b);
+}
+
+// full 128-bit product of two 64-bit magnitudes as (high, low)
+inline void geometry_multiply(uint64_t a, uint64_t b, uint64_t &high, uint64_t &low) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 product = (unsigned __int128) a * b;
+    high = (uint64_t) (product >> 64);
+    low = (uint64_t) product;
+#else
+    uint64_t a_low = a & 0xFFFFFFFFu, a_high = a >> 32;
+    uint64_t b_low = b & 0xFFFFFFFFu, b_high = b >> 32;
+    uint64_t low_low = a_low * b_low;
+    uint64_t middle = a_high * b_low + (low_low >> 32);
+    uint64_t middle_low = (middle & 0xFFFFFFFFu) + a_low * b_high;
+    high = a_high * b_high + (middle >> 32) + (middle_low >> 32);
+    low = (middle_low << 32) | (low_low & 0xFFFFFFFFu);
+#endif
+}
+
+// a - b of two 64-bit integers as a sign (-1, 0, 1) and a magnitude, which always fits 64 bits unsigned
+template<typename T>
+void geometry_difference(T a, T b, int &sign, uint64_t &magnitude) {
+    sign = geometry_compare(a, b);
+    magnitude = a >= b ? (uint64_t) a - (uint64_t) b : (uint64_t) b - (uint64_t) a;
+}
+
+// sign of (ax - cx) * (by - cy) - (ay - cy) * (bx - cx) for 64-bit integers
+template<typename T>
+int orientation_sign_magnitude(T ax, T ay, T bx, T by, T cx, T cy) {
+    int s1, s2, s3, s4;
+    uint64_t m1, m2, m3, m4;
+    geometry_difference(ax, cx, s1, m1);
+    geometry_difference(by, cy, s2, m2);
+    geometry_difference(ay, cy, s3, m3);
+    geometry_difference(bx, cx, s4, m4);
+    int left = s1 * s2;
+    int right = s3 * s4;
+    if (left != right) return geometry_compare(left, right);
+    if (left == 0) return 0;
+    uint64_t left_high, left_low, right_high, right_low;
+    geometry_multiply(m1, m2, left_high, left_low);
+    geometry_multiply(m3, m4, right_high, right_low);
+    int magnitude = left_high != right_high ? geometry_compare(left_high, right_high)
+                                            : geometry_compare(left_low, right_low);
+    return left > 0 ? magnitude : -magnitude;
+}
+
+// error-free transformations: a + b == sum + error and a * b == product + error exactly
+inline void geometry_two_sum(double a, double b, double &sum, double &error) {
+    sum = a + b;
+    double b_virtual = sum - a;
+    double a_virtual = sum - b_virtual;
+    error = (a - a_virtual) + (b - b_virtual);
+}
+
+inline void geometry_two_product(double a, double b, double &product, double &error) {
+    product = a * b;
+    error = std::fma(a, b, -product);
+}
+
+// exact sign of the orientation determinant: its six products are split into twelve doubles whose sum is kept
+// as a nonoverlapping expansion, the sign of which is the sign of its largest component
+inline int orientation_exact(double ax, double ay, double bx, double by, double cx, double cy) {
+    double terms[12];
+    geometry_two_product(ax, by, terms[0], terms[1]);
+    geometry_two_product(-ay, bx, terms[2], terms[3]);
+    geometry_two_product(bx, cy, terms[4], terms[5]);
+    geometry_two_product(-by, cx, terms[6], terms[7]);
+    geometry_two_product(cx, ay, terms[8], terms[9]);
+    geometry_two_product(-cy, ax, terms[10], terms[11]);
+    double expansion[13];
+    int length = 0;
+    for (double term: terms) { // grow-expansion: ripple the new term through the components
+        double carry = term;
+        for (int i = 0; i < length; i++) geometry_two_sum(carry, expansion[i], carry, expansion[i]);
+        expansion[length++] = carry;
+    }
+    for (int i = length - 1; i >= 0; i--) {
+        if (expansion[i] != 0) return expansion[i] > 0 ? 1 : -1;
+    }
+    return 0;
+}
+
+inline int orientation_adaptive(double ax, double ay, double bx, double by, double cx, double cy) {
+    // (3 + 16 epsilon) epsilon with epsilon = 2^-53, the error bound of the plain determinant
+    const double error_factor = 3.3306690738754716e-16;
+    double left = (ax - cx) * (by - cy);
+    double right = (ay - cy) * (bx - cx);
+    double determinant = left - right;
+    double magnitude;
+    if (left > 0) {
+        if (right <= 0) return geometry_compare(determinant, 0.0);
+        magnitude = left + right;
+    }
+    else if (left < 0) {
+        if (right >= 0) return geometry_compare(determinant, 0.0);
+        magnitude = -left - right;
+    }
+    else return geometry_compare(determinant, 0.0);
+    double bound = error_factor * magnitude;
+    if (determinant > bound || -determinant > bound) return determinant > 0 ? 1 : -1;
+    return orientation_exact(ax, ay, bx, by, cx, cy);
+}
+
+// 1 when a, b, c turn counter-clockwise, -1 when clockwise, 0 when they are collinear
+template<typename T>
+int orientation(T ax, T ay, T bx, T by, T cx, T cy) {
+    static_assert(std::is_arithmetic<T>::value, "orientation needs arithmetic coordinates");
+    if constexpr (std::is_floating_point<T>::value) {
+        static_assert(sizeof(T) <= sizeof(double), "long double coordinates are not supported");
+        return orientation_adaptive(ax, ay, bx, by, cx, cy);
+    }
+    else if constexpr (sizeof(T) <= 2) {
+        long long left = ((long long) ax - cx) * ((long long) by - cy);
+        long long right = ((long long) ay - cy) * ((long long) bx - cx);
+        return geometry_compare(left, right);
+    }
+#ifdef __SIZEOF_INT128__
+    else if constexpr (sizeof(T) <= 4) {
+        long long d1 = (long long) ax - cx, d2 = (long long) by - cy;
+        long long d3 = (long long) ay - cy, d4 = (long long) bx - cx;
+        // differences within 31 bits, the common case, keep the products in 64 bits
+        const uint64_t offset = uint64_t(1) << 31;
+        if ((((uint64_t) d1 + offset) | ((uint64_t) d2 + offset) | ((uint64_t) d3 + offset) | ((uint64_t) d4 + offset)) >> 32 == 0)
+            return geometry_compare(d1 * d2, d3 * d4);
+        return geometry_compare((__int128) d1 * d2, (__int128) d3 * d4);
+    }
+#endif
+    else return orientation_sign_magnitude(ax, ay, bx, by, cx, cy);
+}
+
+template<typename Point>
+int orientation(const Point &a, const Point &b, const Point &c) {
+    return orientation(a.x, a.y, b.x, b.y, c.x, c.y);
+}
+
+#endif //VE281P1_GEOMETRY_HPP
@@ -0,0 +1,427 @@
+#ifndef VE281P1_HULL_HPP
+#define VE281P1_HULL_HPP
+
+#include "sort.hpp"
+#include "geometry.hpp"
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <cstdint>
+
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+/**
+ * Convex hulls of point sets, Andrew's monotone chain behind an Akl-Toussaint pre-filter.
+ *
+ * Points are any type with members x and y. The points are never moved: the hull is returned as indices into the
+ * input, counter-clockwise and starting from the lowest point (smallest y, then smallest x), the same order the
+ * Graham scan of p1 prints. Points lying on a hull edge and repeated points are left out.
+ * No state outside the arguments is used, so any number of hulls can be computed at once.
+ * The turns are decided by the exact orientation predicate of geometry.hpp, so the coordinates can be of any
+ * integral or floating point type and use their full range.
+ */
+
+// below this many points the Akl-Toussaint filter costs more than it saves
+constexpr size_t AKL_TOUSSAINT_THRESHOLD = 64;
+
+// Akl-Toussaint heuristic: fill order with the indices of points[0, size) that may be hull vertices.
+// One pass finds the extreme points in the directions x, y, x + y and x - y, a second one drops every point
+// strictly inside the octagon they span, with a branch-free test so the loop compiles to straight-line code.
+// On dense clouds almost every point is dropped before the O(n log n) sort.
+template<typename Point>
+void akl_toussaint_filter(const Point *points, size_t size, std::vector<size_t> &order) {
+    typedef typename std::decay<decltype(points[0].x)>::type Coordinate;
+    typedef geometry_wide_t<Coordinate> Wide;
+    order.resize(size);
+    if (size < AKL_TOUSSAINT_THRESHOLD) {
+        for (size_t i = 0; i < size; i++) order[i] = i;
+        return;
+    }
+    // counter-clockwise from the bottom: -y, x - y, x, x + y, y, y - x, -x, -x - y
+    auto scores = [points](size_t i, Wide *score) {
+        Wide x = points[i].x, y = points[i].y;
+        Wide all[8] = {-y, x - y, x, x + y, y, y - x, -x, -x - y};
+        std::copy(all, all + 8, score);
+    };
+    size_t extreme[8] = {};
+    Wide best[8];
+    scores(0, best);
+    for (size_t i = 1; i < size; i++) {
+        Wide score[8];
+        scores(i, score);
+        for (int d = 0; d < 8; d++) {
+            bool better = score[d] > best[d];
+            best[d] = better ? score[d] : best[d];
+            extreme[d] = better ? i : extreme[d];
+        }
+    }
+    size_t octagon[8];
+    int corners = 0;
+    for (int d = 0; d < 8; d++) {
+        const Point &p = points[extreme[d]];
+        if (corners > 0 && p.x == points[octagon[corners - 1]].x && p.y == points[octagon[corners - 1]].y) continue;
+        octagon[corners++] = extreme[d];
+    }
+    while (corners > 1 && points[octagon[corners - 1]].x == points[octagon[0]].x &&
+           points[octagon[corners - 1]].y == points[octagon[0]].y)
+        corners--;
+    // a flat octagon has no inside; a reflex corner can only come from rounded scores of floating point
+    // coordinates, and then the octagon is not trusted to lie inside the hull
+    bool convex = corners >= 3;
+    for (int c = 0; c < corners && convex; c++)
+        convex = orientation(points[octagon[c]], points[octagon[(c + 1) % corners]], points[octagon[(c + 2) % corners]]) >= 0;
+    if (!convex) {
+        for (size_t i = 0; i < size; i++) order[i] = i;
+        return;
+    }
+    // missing corners repeat the closing edge so the tests below always have eight
+    const Point *from[8], *to[8];
+    for (int c = 0; c < 8; c++) {
+        from[c] = &points[octagon[std::min(c, corners - 1)]];
+        to[c] = &points[octagon[c + 1 < corners ? c + 1 : 0]];
+    }
+    size_t kept = 0;
+    if constexpr (std::is_integral<Coordinate>::value) {
+        // when the cloud spans less than 2^31 in x and y, coordinates taken relative to a corner
+        // give edge tests dx * y - dy * x > bound whose products all fit 64 bits, whatever the coordinate width
+        const Wide limit = Wide(1) << 31;
+        if (best[2] + best[6] < limit && best[4] + best[0] < limit) {
+            // the difference is taken modulo 2^64, so it is exact for 64-bit coordinates of either signedness
+            auto relative = [](Coordinate a, Coordinate b) {
+                return (long long)((unsigned long long)a - (unsigned long long)b);
+            };
+            Coordinate origin_x = points[octagon[0]].x, origin_y = points[octagon[0]].y;
+            long long dx[8], dy[8], bound[8];
+            for (int c = 0; c < 8; c++) {
+                dx[c] = relative(to[c]->x, from[c]->x);
+                dy[c] = relative(to[c]->y, from[c]->y);
+                bound[c] = dx[c] * relative(from[c]->y, origin_y) - dy[c] * relative(from[c]->x, origin_x);
+            }
+            for (size_t i = 0; i < size; i++) {
+                long long x = relative(points[i].x, origin_x), y = relative(points[i].y, origin_y);
+                bool inside = true;
+                for (int c = 0; c < 8; c++) inside &= dx[c] * y - dy[c] * x > bound[c];
+                order[kept] = i;
+                kept += !inside;
+            }
+            order.resize(kept);
+            return;
+        }
+    }
+    for (size_t i = 0; i < size; i++) {
+        bool inside = true;
+        for (int c = 0; c < 8; c++) inside &= orientation(*from[c], *to[c], points[i]) > 0;
+        order[kept] = i;
+        kept += !inside;
+    }
+    order.resize(kept);
+}
+
+// scratch of one hull computation, keep one around to compute many hulls without allocating
+struct hull_workspace {
+    std::vector<size_t> order;
+    std::vector<size_t> chain;
+};
+
+// monotone chain over the indices in order, already sorted by (x, y) and without repeated points;
+// the hull is written to chain, starting from the leftmost point
+template<typename Point>
+void monotone_chain(const Point *points, const std::vector<size_t> &order, std::vector<size_t> &chain) {
+    size_t n = order.size();
+    chain.resize(2 * n);
+    if (n < 3) {
+        std::copy(order.begin(), order.end(), chain.begin());
+        chain.resize(n);
+        return;
+    }
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) { // lower chain, left to right
+        while (k >= 2 && orientation(points[chain[k - 2]], points[chain[k - 1]], points[order[i]]) <= 0) k--;
+        chain[k++] = order[i];
+    }
+    for (size_t i = n - 1, lower = k + 1; i-- > 0;) { // upper chain, right to left
+        while (k >= lower && orientation(points[chain[k - 2]], points[chain[k - 1]], points[order[i]]) <= 0) k--;
+        chain[k++] = order[i];
+    }
+    chain.resize(k - 1); // the leftmost point closes the upper chain again
+}
+
+// the hull of points[0, size) as indices into points, written to workspace.chain
+template<typename Point>
+void convex_hull(const Point *points, size_t size, hull_workspace &workspace) {
+    std::vector<size_t> &order = workspace.order;
+    akl_toussaint_filter(points, size, order);
+    auto less_xy = [points](size_t a, size_t b) {
+        return points[a].x < points[b].x || (points[a].x == points[b].x && points[a].y < points[b].y);
+    };
+    intro_sort(order.begin(), order.end(), less_xy);
+    auto same = [points](size_t a, size_t b) { return points[a].x == points[b].x && points[a].y == points[b].y; };
+    order.erase(std::unique(order.begin(), order.end(), same), order.end());
+    monotone_chain(points, order, workspace.chain);
+    // start from the lowest point like the Graham scan does, the chain starts from the leftmost one
+    std::vector<size_t> &chain = workspace.chain;
+    auto lower = [points](size_t a, size_t b) {
+        return points[a].y < points[b].y || (points[a].y == points[b].y && points[a].x < points[b].x);
+    };
+    std::rotate(chain.begin(), std::min_element(chain.begin(), chain.end(), lower), chain.end());
+}
+
+template<typename Point>
+std::vector<size_t> convex_hull(const Point *points, size_t size) {
+    hull_workspace workspace;
+    convex_hull(points, size, workspace);
+    return std::move(workspace.chain);
+}
+
+template<typename Point>
+std::vector<size_t> convex_hull(const std::vector<Point> &points) {
+    return convex_hull(points.data(), points.size());
+}
+
+// points handed to one task of the parallel hull at a time, bounds the scratch every thread keeps
+constexpr size_t PARALLEL_HULL_CHUNK = 1 << 20;
+
+// Divide and conquer hull on the shared pool: every thread takes chunks of PARALLEL_HULL_CHUNK points in turn and
+// keeps the vertices of their hulls, one final hull over all those vertices gives the answer.
+// A thread never holds more than one chunk of scratch plus its hull vertices, whatever the input size.
+template<typename Point>
+std::vector<size_t> parallel_convex_hull(const Point *points, size_t size) {
+    sort_thread_pool &pool = sort_thread_pool::shared();
+    size_t chunks = (size + PARALLEL_HULL_CHUNK - 1) / PARALLEL_HULL_CHUNK;
+    size_t threads = std::min(pool.size() + 1, chunks);
+    if (threads < 2) return convex_hull(points, size);
+    std::vector<std::vector<size_t>> candidates(threads);
+    std::atomic<size_t> next_chunk{0};
+    pool.parallel_for(threads, [&](size_t thread) {
+        hull_workspace workspace;
+        for (size_t chunk = next_chunk++; chunk < chunks; chunk = next_chunk++) {
+            size_t first = chunk * PARALLEL_HULL_CHUNK;
+            convex_hull(points + first, std::min(PARALLEL_HULL_CHUNK, size - first), workspace);
+            for (size_t i: workspace.chain) candidates[thread].push_back(first + i);
+        }
+    });
+    std::vector<size_t> index;
+    for (auto &list: candidates) index.insert(index.end(), list.begin(), list.end());
+    std::vector<Point> merged(index.size());
+    for (size_t i = 0; i < index.size(); i++) merged[i] = points[index[i]];
+    std::vector<size_t> hull = convex_hull(merged.data(), merged.size());
+    for (auto &i: hull) i = index[i];
+    return hull;
+}
+
+template<typename Point>
+std::vector<size_t> parallel_convex_hull(const std::vector<Point> &points) {
+    return parallel_convex_hull(points.data(), points.size());
+}
+
+template<typename Point>
+bool hull_same_point(const Point &a, const Point &b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+// for near and far on one ray from p: near lies strictly closer to p than far
+template<typename Point>
+bool hull_closer(const Point &p, const Point &near, const Point &far) {
+    return std::min(p.x, far.x) <= near.x && near.x <= std::max(p.x, far.x) &&
+           std::min(p.y, far.y) <= near.y && near.y <= std::max(p.y, far.y) && !hull_same_point(near, far);
+}
+
+// Of the vertices points[hull[0]] ... points[hull[size - 1]] of a convex polygon (counter-clockwise, no three
+// collinear), the position of the one all the others lie left of, or on the line, as seen from p; the farthest one
+// when two qualify. Vertices equal to p are skipped, size is returned when every vertex equals p.
+// p has to lie outside the polygon or on one of its vertices, as every hull vertex does for every group in Chan's
+// algorithm. Ranked by "more clockwise from p, then farther", with a vertex equal to p last, the vertices then rise
+// once and fall once around the polygon, so a binary search finds the first one. A linear scan is the safety net.
+template<typename Point>
+size_t chan_tangent(const Point *points, const size_t *hull, size_t size, const Point &p) {
+    auto at = [points, hull, size](size_t i) -> const Point & { return points[hull[i % size]]; };
+    // i ranks before j: j lies left of the ray from p through i, or on it and closer to p
+    auto before = [&at, &p](size_t i, size_t j) {
+        if (hull_same_point(at(i), p)) return false;
+        if (hull_same_point(at(j), p)) return true;
+        int turn = orientation(p, at(i), at(j));
+        return turn > 0 || (turn == 0 && hull_closer(p, at(j), at(i)));
+    };
+    if (size > 3) {
+        // the first vertex q lies in (a, b]; rising(i) when i ranks before i + 1
+        size_t a = 0, b = size;
+        bool a_rising = before(0, 1);
+        while (b - a > 1) {
+            size_t c = (a + b) / 2;
+            bool c_rising = before(c, c + 1);
+            bool after_a = before(a, c);
+            // a rising: c is on a's run before the top (rising, above a) or falls towards q, else it is past q;
+            // a falling: c still falls towards q when it falls below a, else it is past q
+            bool toward_q = a_rising ? !c_rising || after_a : !c_rising && !after_a;
+            if (toward_q) {
+                a = c;
+                a_rising = c_rising;
+            }
+            else b = c;
+        }
+        size_t q = b % size;
+        if (!hull_same_point(at(q), p) && before(q, q + size - 1) && before(q, q + 1)) return q;
+    }
+    size_t best = size;
+    for (size_t i = 0; i < size; i++) {
+        if (hull_same_point(at(i), p)) continue;
+        if (best == size || before(i, best)) best = i;
+    }
+    return best;
+}
+
+// below this many points the monotone chain is faster than any output-sensitive attempt
+constexpr size_t CHAN_MIN_POINTS = 1 << 16;
+
+// largest hull the automatic choice expects Chan's algorithm to win on
+constexpr size_t CHAN_AUTO_MAX_HULL = 64;
+
+// points of the sample whose hull decides whether the automatic choice tries Chan's algorithm at all
+constexpr size_t CHAN_AUTO_SAMPLE = 4096;
+
+/**
+ * Chan's output-sensitive algorithm, O(n log h) for a hull of h vertices.
+ *
+ * Round t splits the points into groups of m = 2^(2^t), starting from m = 16, takes the hull of every group with convex_hull and then
+ * gift-wraps at most m steps around the groups, finding the next vertex in every group by a binary search.
+ * When m steps are not enough the round is given up and m squared. Writes the hull, in the order convex_hull
+ * returns it, to hull and returns true; returns false as soon as the hull is known to have more than max_hull
+ * vertices, which keeps a wrong guess of a small hull cheap.
+ */
+template<typename Point>
+bool chan_convex_hull(const Point *points, size_t size, std::vector<size_t> &hull, size_t max_hull = SIZE_MAX) {
+    hull.clear();
+    hull_workspace workspace;
+    std::vector<size_t> vertices; // the group hulls back to back, as indices into points
+    std::vector<size_t> offsets;  // group g owns vertices[offsets[g], offsets[g + 1])
+    // a bounded search needs one round only: groups of max_hull points wrap any hull it accepts
+    size_t first_group = max_hull < SIZE_MAX ? std::max<size_t>(16, max_hull) : 16;
+    for (size_t group = first_group;; group = group > size / group ? size : group * group) {
+        if (group >= size) { // one group: its hull is the answer
+            convex_hull(points, size, workspace);
+            if (workspace.chain.size() > max_hull) return false;
+            hull = workspace.chain;
+            return true;
+        }
+        vertices.clear();
+        offsets.assign(1, 0);
+        for (size_t first = 0; first < size; first += group) {
+            convex_hull(points + first, std::min(group, size - first), workspace);
+            for (size_t i: workspace.chain) vertices.push_back(first + i);
+            offsets.push_back(vertices.size());
+        }
+        size_t groups = offsets.size() - 1;
+        // every group hull starts at its lowest point, the lowest of those starts the wrap
+        auto lower = [points](size_t a, size_t b) {
+            return points[a].y < points[b].y || (points[a].y == points[b].y && points[a].x < points[b].x);
+        };
+        size_t current_group = 0;
+        for (size_t g = 1; g < groups; g++) {
+            if (lower(vertices[offsets[g]], vertices[offsets[current_group]])) current_group = g;
+        }
+        size_t current = offsets[current_group];
+        const Point &start = points[vertices[current]];
+        hull.assign(1, vertices[current]);
+        size_t steps = std::min(group, max_hull);
+        for (size_t step = 0; step < steps; step++) {
+            const Point &p = points[vertices[current]];
+            size_t best = vertices.size(), best_group = 0;
+            auto consider = [&](size_t position, size_t g) {
+                const Point &candidate = points[vertices[position]];
+                if (hull_same_point(candidate, p)) return;
+                int side = best == vertices.size() ? -1 : orientation(p, points[vertices[best]], candidate);
+                if (side < 0 || (side == 0 && hull_closer(p, points[vertices[best]], candidate))) {
+                    best = position;
+                    best_group = g;
+                }
+            };
+            for (size_t g = 0; g < groups; g++) {
+                size_t length = offsets[g + 1] - offsets[g];
+                if (g == current_group) { // p is a vertex of its own group, the next one is its candidate
+                    consider(offsets[g] + (current - offsets[g] + 1) % length, g);
+                    continue;
+                }
+                size_t tangent = chan_tangent(points, vertices.data() + offsets[g], length, p);
+                if (tangent < length) consider(offsets[g] + tangent, g);
+            }
+            if (best == vertices.size() || hull_same_point(points[vertices[best]], start)) return true;
+            hull.push_back(vertices[best]);
+            current = best;
+            current_group = best_group;
+        }
+        if (group >= max_hull) return false;
+    }
+}
+
+template<typename Point>
+std::vector<size_t> chan_convex_hull(const Point *points, size_t size) {
+    std::vector<size_t> hull;
+    chan_convex_hull(points, size, hull);
+    return hull;
+}
+
+template<typename Point>
+std::vector<size_t> chan_convex_hull(const std::vector<Point> &points) {
+    return chan_convex_hull(points.data(), points.size());
+}
+
+// Picks the hull algorithm from the input. The Akl-Toussaint filter runs first; when it leaves few points the
+// monotone chain finishes them cheaply. When many points survive (they crowd the boundary) the hull of an evenly
+// strided sample of them estimates the hull size: points on the boundary of an h-gon have a hull of at most 2h
+// vertices, so a sample hull above 2 * CHAN_AUTO_MAX_HULL goes straight to the parallel monotone chain. Otherwise
+// Chan's algorithm is tried, and the parallel monotone chain still takes over once the hull is known not to be small.
+template<typename Point>
+std::vector<size_t> auto_convex_hull(const Point *points, size_t size) {
+    if (size < CHAN_MIN_POINTS) return convex_hull(points, size);
+    std::vector<size_t> survivors;
+    akl_toussaint_filter(points, size, survivors);
+    std::vector<Point> compact(survivors.size());
+    for (size_t i = 0; i < survivors.size(); i++) compact[i] = points[survivors[i]];
+    std::vector<size_t> hull;
+    if (compact.size() < CHAN_MIN_POINTS) hull = convex_hull(compact.data(), compact.size());
+    else {
+        std::vector<Point> sample(CHAN_AUTO_SAMPLE);
+        for (size_t i = 0; i < sample.size(); i++) sample[i] = compact[i * compact.size() / sample.size()];
+        if (convex_hull(sample).size() > 2 * CHAN_AUTO_MAX_HULL ||
+            !chan_convex_hull(compact.data(), compact.size(), hull, CHAN_AUTO_MAX_HULL))
+            hull = parallel_convex_hull(compact.data(), compact.size());
+    }
+    for (auto &i: hull) i = survivors[i];
+    return hull;
+}
+
+template<typename Point>
+std::vector<size_t> auto_convex_hull(const std::vector<Point> &points) {
+    return auto_convex_hull(points.data(), points.size());
+}
+
+#if __cplusplus >= 202002L
+template<typename Point, size_t Extent>
+std::vector<size_t> parallel_convex_hull(std::span<const Point, Extent> points) {
+    return parallel_convex_hull(points.data(), points.size());
+}
+
+template<typename Point, size_t Extent>
+std::vector<size_t> chan_convex_hull(std::span<const Point, Extent> points) {
+    return chan_convex_hull(points.data(), points.size());
+}
+
+template<typename Point, size_t Extent>
+std::vector<size_t> auto_convex_hull(std::span<const Point, Extent> points) {
+    return auto_convex_hull(points.data(), points.size());
+}
+
+template<typename Point, size_t Extent>
+std::vector<size_t> convex_hull(std::span<const Point, Extent> points) {
+    return convex_hull(points.data(), points.size());
+}
+
+template<typename Point, size_t Extent>
+void convex_hull(std::span<const Point, Extent> points, hull_workspace &workspace) {
+    convex_hull(points.data(), points.size(), workspace);
+}
+#endif
+
+#endif //VE281P1_HULL_HPP
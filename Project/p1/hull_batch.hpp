@@ -0,0 +1,92 @@
+#ifndef VE281P1_HULL_BATCH_HPP
+#define VE281P1_HULL_BATCH_HPP
+
+#include "hull.hpp"
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * Many small hulls at once.
+ *
+ * The input is in CSR form: one array of points and an array of offsets, hull g being the hull of
+ * points[offsets[g], offsets[g + 1]). The groups are handed to the shared sort pool in tasks of consecutive groups,
+ * every thread computes its hulls in one hull_workspace it keeps for all of them and writes every hull to the slot
+ * of its group in one scratch array (a hull never has more vertices than its group has points). A prefix sum over
+ * the hull sizes then packs the slots into one contiguous output. A hull_batch passed again keeps all of that
+ * memory, so a steady stream of batches allocates nothing once it has seen its largest batch.
+ */
+
+// groups handed to one task of the batch at a time
+constexpr size_t HULL_BATCH_TASK = 1024;
+
+struct hull_batch {
+    // hull g is index[offsets[g], offsets[g + 1]): indices into the points, in the order convex_hull returns them
+    std::vector<size_t> offsets;
+    std::vector<size_t> index;
+
+    // scratch kept between batches
+    std::vector<size_t> slots;
+    std::vector<hull_workspace> workspaces;
+
+    size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+};
+
+// the hulls of the groups points[offsets[g], offsets[g + 1]) for g in [0, groups), into result
+template<typename Point>
+void convex_hull_batch(const Point *points, const size_t *offsets, size_t groups, hull_batch &result) {
+    for (size_t g = 0; g < groups; g++) {
+        if (offsets[g] > offsets[g + 1]) throw std::invalid_argument("convex_hull_batch: offsets must not decrease");
+    }
+    result.offsets.assign(groups + 1, 0);
+    result.index.clear();
+    if (groups == 0) return;
+    size_t first_point = offsets[0];
+    result.slots.resize(offsets[groups] - first_point);
+    sort_thread_pool &pool = sort_thread_pool::shared();
+    size_t tasks = (groups + HULL_BATCH_TASK - 1) / HULL_BATCH_TASK;
+    size_t threads = std::max<size_t>(std::min(pool.size() + 1, tasks), 1);
+    result.workspaces.resize(threads);
+    // body(begin, end, thread) over all tasks, spread over the threads
+    auto for_tasks = [&](const auto &body) {
+        if (threads < 2) return body(0, groups, 0);
+        std::atomic<size_t> next_task{0};
+        pool.parallel_for(threads, [&](size_t thread) {
+            for (size_t task = next_task++; task < tasks; task = next_task++) {
+                size_t begin = task * HULL_BATCH_TASK;
+                body(begin, std::min(begin + HULL_BATCH_TASK, groups), thread);
+            }
+        });
+    };
+    // hull sizes go to result.offsets[g + 1] first
+    for_tasks([&](size_t begin, size_t end, size_t thread) {
+        hull_workspace &workspace = result.workspaces[thread];
+        for (size_t g = begin; g < end; g++) {
+            convex_hull(points + offsets[g], offsets[g + 1] - offsets[g], workspace);
+            size_t *slot = result.slots.data() + (offsets[g] - first_point);
+            for (size_t i: workspace.chain) *slot++ = offsets[g] + i;
+            result.offsets[g + 1] = workspace.chain.size();
+        }
+    });
+    for (size_t g = 0; g < groups; g++) result.offsets[g + 1] += result.offsets[g];
+    result.index.resize(result.offsets[groups]);
+    for_tasks([&](size_t begin, size_t end, size_t) {
+        for (size_t g = begin; g < end; g++) {
+            const size_t *slot = result.slots.data() + (offsets[g] - first_point);
+            std::copy(slot, slot + (result.offsets[g + 1] - result.offsets[g]), result.index.begin() + result.offsets[g]);
+        }
+    });
+}
+
+// offsets has one entry more than there are groups, the last one being points.size() usually
+template<typename Point>
+hull_batch convex_hull_batch(const std::vector<Point> &points, const std::vector<size_t> &offsets) {
+    if (offsets.empty() || offsets.back() > points.size())
+        throw std::invalid_argument("convex_hull_batch: offsets do not fit the points");
+    hull_batch result;
+    convex_hull_batch(points.data(), offsets.data(), offsets.size() - 1, result);
+    return result;
+}
+
+#endif //VE281P1_HULL_BATCH_HPP
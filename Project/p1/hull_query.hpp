@@ -0,0 +1,198 @@
+#ifndef VE281P1_HULL_QUERY_HPP
+#define VE281P1_HULL_QUERY_HPP
+
+#include "geometry.hpp"
+#include "sort_simd.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+/**
+ * Point-in-hull tests against a fixed convex hull, O(log h) each.
+ *
+ * The hull is seen as a fan of triangles around its lowest vertex v0: a binary search over the angle of the query
+ * around v0 finds its triangle, one more orientation test against the far edge decides. Points on the boundary
+ * count as inside.
+ *
+ * The batch entry point runs that search in AVX2 lanes, four queries at a time with gathered vertices and a
+ * fixed number of steps, when the coordinates are integers and the hull spans less than 2^30 in x and y:
+ * then every coordinate relative to v0 of a query inside the bounding box fits 31 bits and the products of the
+ * tests fit 64 bits exactly. Other hulls, other CPUs and queries outside the bounding box take the scalar path.
+ */
+
+// relative coordinates of a packed hull stay below this, see above
+constexpr int64_t HULL_QUERY_PACKED_SPAN = int64_t(1) << 30;
+
+// queries converted to relative coordinates per kernel call
+constexpr size_t HULL_QUERY_BLOCK = 256;
+
+// The fan search over a packed hull of h >= 3 vertices at (xs[i], ys[i]) relative to v0, for the count queries at
+// (px[i], py[i]), also relative to v0; count is a multiple of 4.
+inline void hull_query_scalar(const int64_t *xs, const int64_t *ys, size_t h, const int64_t *px, const int64_t *py,
+                              size_t count, uint8_t *inside) {
+    for (size_t i = 0; i < count; i++) {
+        int64_t x = px[i], y = py[i];
+        bool ok = xs[1] * y - ys[1] * x >= 0 && xs[h - 1] * y - ys[h - 1] * x <= 0;
+        size_t base = 1;
+        for (size_t length = h - 2; length > 1; length -= length / 2) {
+            size_t middle = base + length / 2;
+            if (xs[middle] * y - ys[middle] * x >= 0) base = middle;
+        }
+        int64_t edge = (xs[base + 1] - xs[base]) * (y - ys[base]) - (ys[base + 1] - ys[base]) * (x - xs[base]);
+        inside[i] = ok && edge >= 0;
+    }
+}
+
+#ifdef VE281P1_SORT_SIMD_X86
+// the low 32 bits of the lanes are signed operands, products are exact 64 bits
+VE281P1_AVX2 inline __m256i hull_query_cross_avx2(__m256i ax, __m256i ay, __m256i bx, __m256i by) {
+    return _mm256_sub_epi64(_mm256_mul_epi32(ax, by), _mm256_mul_epi32(ay, bx));
+}
+
+VE281P1_AVX2 inline void hull_query_avx2(const int64_t *xs, const int64_t *ys, size_t h, const int64_t *px,
+                                         const int64_t *py, size_t count, uint8_t *inside) {
+    const long long *gx = reinterpret_cast<const long long *>(xs);
+    const long long *gy = reinterpret_cast<const long long *>(ys);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i first_x = _mm256_set1_epi64x(xs[1]), first_y = _mm256_set1_epi64x(ys[1]);
+    const __m256i last_x = _mm256_set1_epi64x(xs[h - 1]), last_y = _mm256_set1_epi64x(ys[h - 1]);
+    for (size_t i = 0; i < count; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) (px + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *) (py + i));
+        // outside when clockwise of the first fan edge or counter-clockwise of the last
+        __m256i out = _mm256_or_si256(_mm256_cmpgt_epi64(zero, hull_query_cross_avx2(first_x, first_y, x, y)),
+                                      _mm256_cmpgt_epi64(hull_query_cross_avx2(last_x, last_y, x, y), zero));
+        __m256i base = one;
+        for (size_t length = h - 2; length > 1; length -= length / 2) {
+            __m256i half = _mm256_set1_epi64x((long long) (length / 2));
+            __m256i middle = _mm256_add_epi64(base, half);
+            __m256i vx = _mm256_i64gather_epi64(gx, middle, 8);
+            __m256i vy = _mm256_i64gather_epi64(gy, middle, 8);
+            __m256i behind = _mm256_cmpgt_epi64(zero, hull_query_cross_avx2(vx, vy, x, y));
+            base = _mm256_add_epi64(base, _mm256_andnot_si256(behind, half));
+        }
+        __m256i next = _mm256_add_epi64(base, one);
+        __m256i lx = _mm256_i64gather_epi64(gx, base, 8), ly = _mm256_i64gather_epi64(gy, base, 8);
+        __m256i hx = _mm256_i64gather_epi64(gx, next, 8), hy = _mm256_i64gather_epi64(gy, next, 8);
+        __m256i edge = hull_query_cross_avx2(_mm256_sub_epi64(hx, lx), _mm256_sub_epi64(hy, ly),
+                                             _mm256_sub_epi64(x, lx), _mm256_sub_epi64(y, ly));
+        out = _mm256_or_si256(out, _mm256_cmpgt_epi64(zero, edge));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(out));
+        for (int lane = 0; lane < 4; lane++) inside[i + lane] = !(mask >> lane & 1);
+    }
+}
+#endif
+
+template<typename Point>
+class hull_query {
+    typedef typename std::decay<decltype(std::declval<Point>().x)>::type Coordinate;
+    std::vector<Point> hull;
+    Point low, high; // bounding box
+    bool packed = false;
+    std::vector<int64_t> xs, ys;
+
+    static bool same(const Point &a, const Point &b) { return a.x == b.x && a.y == b.y; }
+
+    bool in_box(const Point &p) const { return low.x <= p.x && p.x <= high.x && low.y <= p.y && p.y <= high.y; }
+
+    void build() {
+        if (hull.empty()) return;
+        low = high = hull[0];
+        for (auto &vertex: hull) {
+            low.x = std::min(low.x, vertex.x);
+            low.y = std::min(low.y, vertex.y);
+            high.x = std::max(high.x, vertex.x);
+            high.y = std::max(high.y, vertex.y);
+        }
+        if constexpr (std::is_integral<Coordinate>::value) {
+            typedef geometry_wide_t<Coordinate> Wide;
+            packed = hull.size() >= 3 && Wide(high.x) - low.x < HULL_QUERY_PACKED_SPAN &&
+                     Wide(high.y) - low.y < HULL_QUERY_PACKED_SPAN;
+            if (!packed) return;
+            for (auto &vertex: hull) {
+                xs.push_back((int64_t) (Wide(vertex.x) - hull[0].x));
+                ys.push_back((int64_t) (Wide(vertex.y) - hull[0].y));
+            }
+        }
+    }
+
+public:
+    // vertices counter-clockwise from the lowest one, the way convex_hull and incremental_hull return them
+    explicit hull_query(std::vector<Point> vertices) : hull(std::move(vertices)) { build(); }
+
+    // from the indices convex_hull returned for points
+    hull_query(const Point *points, const std::vector<size_t> &index) {
+        for (size_t i: index) hull.push_back(points[i]);
+        build();
+    }
+
+    size_t size() const { return hull.size(); }
+
+    bool contains(const Point &p) const {
+        size_t h = hull.size();
+        if (h == 0 || !in_box(p)) return false;
+        if (h == 1) return same(p, hull[0]);
+        if (h == 2) return orientation(hull[0], hull[1], p) == 0; // the box already bounds the segment
+        const Point &origin = hull[0];
+        if (orientation(origin, hull[1], p) < 0 || orientation(origin, hull[h - 1], p) > 0) return false;
+        size_t base = 1;
+        for (size_t length = h - 2; length > 1; length -= length / 2) {
+            size_t middle = base + length / 2;
+            if (orientation(origin, hull[middle], p) >= 0) base = middle;
+        }
+        return orientation(hull[base], hull[base + 1], p) >= 0;
+    }
+
+    // inside[i] = contains(queries[i]) for every query
+    void contains(const Point *queries, size_t count, bool *inside) const {
+        if (!packed) {
+            for (size_t i = 0; i < count; i++) inside[i] = contains(queries[i]);
+            return;
+        }
+        typedef geometry_wide_t<Coordinate> Wide;
+        int64_t px[HULL_QUERY_BLOCK], py[HULL_QUERY_BLOCK];
+        uint8_t result[HULL_QUERY_BLOCK];
+        bool use_avx2 = detect_simd_level() == simd_level::avx2;
+        for (size_t first = 0; first < count; first += HULL_QUERY_BLOCK) {
+            size_t block = std::min(HULL_QUERY_BLOCK, count - first);
+            size_t padded = (block + 3) / 4 * 4;
+            for (size_t i = 0; i < padded; i++) {
+                // queries outside the box are answered by the box, the kernel sees v0 in their place
+                bool box = i < block && in_box(queries[first + i]);
+                px[i] = box ? (int64_t) (Wide(queries[first + i].x) - hull[0].x) : 0;
+                py[i] = box ? (int64_t) (Wide(queries[first + i].y) - hull[0].y) : 0;
+                result[i] = box;
+            }
+            uint8_t fan[HULL_QUERY_BLOCK];
+#ifdef VE281P1_SORT_SIMD_X86
+            if (use_avx2) hull_query_avx2(xs.data(), ys.data(), hull.size(), px, py, padded, fan);
+            else hull_query_scalar(xs.data(), ys.data(), hull.size(), px, py, padded, fan);
+#else
+            (void) use_avx2;
+            hull_query_scalar(xs.data(), ys.data(), hull.size(), px, py, padded, fan);
+#endif
+            for (size_t i = 0; i < block; i++) inside[first + i] = result[i] && fan[i];
+        }
+    }
+
+    // bit i % 64 of word i / 64 set when queries[i] is inside
+    std::vector<uint64_t> contains_mask(const Point *queries, size_t count) const {
+        std::vector<uint64_t> mask((count + 63) / 64, 0);
+        bool inside[64];
+        for (size_t first = 0; first < count; first += 64) {
+            size_t block = std::min<size_t>(64, count - first);
+            contains(queries + first, block, inside);
+            for (size_t i = 0; i < block; i++) mask[first / 64] |= uint64_t(inside[i]) << i;
+        }
+        return mask;
+    }
+
+    std::vector<uint64_t> contains_mask(const std::vector<Point> &queries) const {
+        return contains_mask(queries.data(), queries.size());
+    }
+};
+
+#endif //VE281P1_HULL_QUERY_HPP
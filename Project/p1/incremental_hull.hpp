@@ -0,0 +1,137 @@
+#ifndef VE281P1_INCREMENTAL_HULL_HPP
+#define VE281P1_INCREMENTAL_HULL_HPP
+
+#include "geometry.hpp"
+#include <map>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+
+/**
+ * Convex hull that grows one point at a time.
+ *
+ * The hull is kept as its upper and lower chains, each a balanced search tree (std::map) keyed by x holding the
+ * strictly convex chain in x order. Inserting a point costs O(log n) to find its place plus O(log n) for every
+ * vertex it removes, and a vertex is removed at most once, so a batch of b insertions costs O(b log n) amortized.
+ * The chains are the live hull: they can be walked at any time without recomputing anything.
+ */
+
+// one chain of the hull in x order: the upper one keeps only right turns, the lower one only left turns
+template<typename Point, bool Upper>
+class hull_chain {
+    typedef typename std::decay<decltype(std::declval<Point>().x)>::type Coordinate;
+    std::map<Coordinate, Point> vertices;
+
+    // a, b, c (in x order) bend the way this chain must bend, strictly
+    static bool convex(const Point &a, const Point &b, const Point &c) {
+        int turn = orientation(a, b, c);
+        return Upper ? turn < 0 : turn > 0;
+    }
+
+public:
+    typedef typename std::map<Coordinate, Point>::const_iterator const_iterator;
+
+    // false when point lies inside or on this chain, which then stays as it is;
+    // the vertices the point removes are appended to erased when it is given
+    bool insert(const Point &point, std::vector<Point> *erased = nullptr) {
+        auto same_x = vertices.find(point.x);
+        if (same_x != vertices.end()) {
+            if (Upper ? same_x->second.y >= point.y : same_x->second.y <= point.y) return false;
+            if (erased) erased->push_back(same_x->second);
+            vertices.erase(same_x);
+        }
+        auto next = vertices.upper_bound(point.x);
+        if (next != vertices.end() && next != vertices.begin() && !convex(std::prev(next)->second, point, next->second))
+            return false;
+        auto inserted = vertices.emplace_hint(next, point.x, point);
+        // neighbours that stopped being corners
+        while (next != vertices.end()) {
+            auto after = std::next(next);
+            if (after == vertices.end() || convex(point, next->second, after->second)) break;
+            if (erased) erased->push_back(next->second);
+            next = vertices.erase(next);
+        }
+        while (inserted != vertices.begin()) {
+            auto before = std::prev(inserted);
+            if (before == vertices.begin() || convex(std::prev(before)->second, before->second, point)) break;
+            if (erased) erased->push_back(before->second);
+            vertices.erase(before);
+        }
+        return true;
+    }
+
+    // takes back the latest insertion still standing, which returned true and erased [erased_first, erased_last)
+    void undo(const Point &point, const Point *erased_first, const Point *erased_last) {
+        vertices.erase(point.x);
+        for (; erased_first != erased_last; ++erased_first) vertices.emplace(erased_first->x, *erased_first);
+    }
+
+    size_t size() const { return vertices.size(); }
+
+    const_iterator begin() const { return vertices.begin(); }
+
+    const_iterator end() const { return vertices.end(); }
+
+    void clear() { vertices.clear(); }
+};
+
+template<typename Point>
+class incremental_hull {
+    hull_chain<Point, true> upper_chain;
+    hull_chain<Point, false> lower_chain;
+
+    static bool same(const Point &a, const Point &b) { return a.x == b.x && a.y == b.y; }
+
+public:
+    // true when the hull changed
+    bool insert(const Point &point) {
+        bool upper = upper_chain.insert(point);
+        bool lower = lower_chain.insert(point);
+        return upper || lower;
+    }
+
+    template<typename InputIt>
+    void insert(InputIt first, InputIt last) {
+        for (; first != last; ++first) insert(*first);
+    }
+
+    bool empty() const { return lower_chain.size() == 0; }
+
+    // the chains themselves, left to right, sharing their two end points
+    const hull_chain<Point, true> &upper() const { return upper_chain; }
+
+    const hull_chain<Point, false> &lower() const { return lower_chain; }
+
+    // calls visit on every hull vertex once, counter-clockwise from the leftmost (lowest on ties) vertex
+    template<typename Visit>
+    void for_each_vertex(Visit visit) const {
+        if (empty()) return;
+        const Point *first = &lower_chain.begin()->second;
+        const Point *last = nullptr;
+        for (auto &vertex: lower_chain) {
+            visit(vertex.second);
+            last = &vertex.second;
+        }
+        for (auto it = std::make_reverse_iterator(upper_chain.end()); it != std::make_reverse_iterator(upper_chain.begin()); ++it) {
+            if (same(it->second, *last) || same(it->second, *first)) continue;
+            visit(it->second);
+        }
+    }
+
+    // the hull in the order convex_hull of hull.hpp returns it: counter-clockwise from the lowest point
+    std::vector<Point> vertices() const {
+        std::vector<Point> hull;
+        for_each_vertex([&hull](const Point &vertex) { hull.push_back(vertex); });
+        auto lower = [](const Point &a, const Point &b) { return a.y < b.y || (a.y == b.y && a.x < b.x); };
+        std::rotate(hull.begin(), std::min_element(hull.begin(), hull.end(), lower), hull.end());
+        return hull;
+    }
+
+    void clear() {
+        upper_chain.clear();
+        lower_chain.clear();
+    }
+};
+
+#endif //VE281P1_INCREMENTAL_HULL_HPP
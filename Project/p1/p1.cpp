@@ -1,61 +1,101 @@
 #include <iostream>
 #include <vector>
-#include <algorithm>
+#include <cstring>
+#include "hull.hpp"
+#include "incremental_hull.hpp"
+#include "point_io.hpp"
 
 using namespace std;
 
+// usage: p1 [--algorithm auto|monotone|parallel|chan|incremental] [input]
+//            hull of the text or binary points in input (default stdin); auto tries Chan's algorithm
+//            when the points crowd the boundary and picks the monotone chain otherwise, incremental
+//            inserts the points one by one into an incremental_hull
+//        p1 --to-binary input output
+//            convert a text point file to the binary format
+
 struct coordinates{
-    int x;
-    int y;
+    long long x;
+    long long y;
 };
 
-coordinates lowest_point = {};
-
-int ccw(const coordinates a, const coordinates b, const coordinates c){
-    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
-}
-
-
-bool compare(const coordinates &a, const coordinates &b){
-    int angle = ccw(lowest_point, a, b);
-    int distance_a = (a.x - lowest_point.x) * (a.x - lowest_point.x) + (a.y - lowest_point.y) * (a.y - lowest_point.y);
-    int distance_b = (b.x - lowest_point.x) * (b.x - lowest_point.x) + (b.y - lowest_point.y) * (b.y - lowest_point.y);
-    if (angle == 0) return distance_a < distance_b;
-    else return angle > 0;
-}
-
-int main() {
-    vector<coordinates> stack;
-    vector<coordinates> result;
-    int size;
-    cin >> size;
-    if (size == 0) return 0;
-    for (int i = 0; i < size; i++){
-        coordinates curr_coordinate = {};
-        cin >> curr_coordinate.x >> curr_coordinate.y;
-        stack.push_back(curr_coordinate);
-    }
-    coordinates p0 = stack[0];
-    for (auto & i: stack){
-        if (((i.y == p0.y) && (i.x < p0.x)) || (i.y < p0.y)) p0 = i;
-    }
-    lowest_point = p0;
-    std::sort(stack.begin(), stack.end(), compare);
-    for (auto & i: stack){
-        while (result.size() > 1){
-            if (ccw(result[result.size() - 2], result.back(), i) <= 0){
-                result.pop_back();
+int main(int argc, char *argv[]) {
+    try {
+        bool convert = argc > 1 && !strcmp(argv[1], "--to-binary");
+        if (convert && argc != 4){
+            cerr << "usage: p1 --to-binary input output" << endl;
+            return 1;
+        }
+        string algorithm = "auto";
+        const char *input_path = convert ? argv[2] : nullptr;
+        for (int i = 1; !convert && i < argc; i++){
+            if (!strcmp(argv[i], "--algorithm") && i + 1 < argc) algorithm = argv[++i];
+            else if (!strcmp(argv[i], "--algorithm") || input_path){
+                // a trailing --algorithm, or a second input
+                cerr << "usage: p1 [--algorithm auto|monotone|parallel|chan|incremental] [input]" << endl;
+                return 1;
             }
-            else break;
+            else input_path = argv[i];
         }
-        result.push_back(i);
-    }
-    for (int i = 0; i < (int)result.size(); i++){
-        if (i != 0){
-            if ((result[i].x != result[i - 1].x) || (result[i].y != result[i - 1].y))
-                cout << result[i].x << " " << result[i].y << endl;
+        if (algorithm != "auto" && algorithm != "monotone" && algorithm != "parallel" && algorithm != "chan" &&
+            algorithm != "incremental"){
+            cerr << "p1: unknown algorithm " << algorithm << endl;
+            return 1;
+        }
+        FILE *file = input_path ? fopen(input_path, "rb") : stdin;
+        if (!file){
+            cerr << "p1: can not open " << input_path << endl;
+            return 1;
+        }
+        vector<coordinates> stack;
+        {
+            input_buffer input(file);
+            stack = read_points<coordinates>(input.begin(), input.end());
+        }
+        if (input_path) fclose(file);
+        if (convert){
+            FILE *target = fopen(argv[3], "wb");
+            if (!target){
+                cerr << "p1: can not open " << argv[3] << endl;
+                return 1;
+            }
+            {
+                output_buffer out(target);
+                write_points_binary(out, stack.data(), stack.size());
+                out.flush();
+            }
+            if (fclose(target) != 0){
+                cerr << "p1: write failed" << endl;
+                return 1;
+            }
+            return 0;
+        }
+        if (stack.empty()) return 0;
+        output_buffer out(stdout);
+        if (algorithm == "incremental"){
+            incremental_hull<coordinates> hull;
+            hull.insert(stack.begin(), stack.end());
+            vector<coordinates> vertices = hull.vertices();
+            vector<size_t> order(vertices.size());
+            for (size_t i = 0; i < order.size(); i++) order[i] = i;
+            write_points_text(out, vertices.data(), order);
+        }
+        else {
+            vector<size_t> result;
+            if (algorithm == "monotone") result = convex_hull(stack);
+            else if (algorithm == "parallel") result = parallel_convex_hull(stack);
+            else if (algorithm == "chan") result = chan_convex_hull(stack);
+            else result = auto_convex_hull(stack);
+            write_points_text(out, stack.data(), result);
+        }
+        out.flush();
+        if (fflush(stdout) != 0 || ferror(stdout)){
+            cerr << "p1: write failed" << endl;
+            return 1;
         }
-        else cout << result[i].x << " " << result[i].y << endl;
     }
-
+    catch (const exception &error){
+        cerr << "p1: " << error.what() << endl;
+        return 1;
+    }
 }
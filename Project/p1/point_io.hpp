@@ -0,0 +1,233 @@
+#ifndef VE281P1_POINT_IO_HPP
+#define VE281P1_POINT_IO_HPP
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VE281P1_POINT_IO_MMAP 1
+#endif
+
+/**
+ * Bulk point input and output for the hull tool.
+ *
+ * Two input formats, told apart by the first bytes:
+ * - text: the point count, then x y for every point, all whitespace separated decimal integers
+ * - binary: the 8 bytes of POINT_FILE_MAGIC, the point count as uint64, then x and y of every point as int64,
+ *   everything in host byte order
+ * The input is mapped into memory when it is a regular file and read in large blocks otherwise (pipes),
+ * integers are parsed by hand, and the output is formatted into one buffer written in large blocks.
+ */
+
+constexpr size_t POINT_IO_BLOCK_BYTES = 1 << 20;
+constexpr char POINT_FILE_MAGIC[8] = {'V', 'E', '2', '8', '1', 'P', 'T', 'S'};
+
+// the whole content of an open file
+class input_buffer {
+    const char *data = nullptr;
+    size_t length = 0;
+    std::vector<char> owned;
+    bool mapped = false;
+
+public:
+    explicit input_buffer(std::FILE *file) {
+#ifdef VE281P1_POINT_IO_MMAP
+        struct stat status;
+        int descriptor = fileno(file);
+        if (fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0) {
+            void *address = mmap(nullptr, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (address != MAP_FAILED) {
+                madvise(address, (size_t) status.st_size, MADV_SEQUENTIAL);
+                data = static_cast<const char *>(address);
+                length = (size_t) status.st_size;
+                mapped = true;
+                return;
+            }
+        }
+#endif
+        size_t used = 0;
+        while (true) {
+            owned.resize(used + POINT_IO_BLOCK_BYTES);
+            size_t count = std::fread(owned.data() + used, 1, POINT_IO_BLOCK_BYTES, file);
+            used += count;
+            if (count < POINT_IO_BLOCK_BYTES) break;
+        }
+        if (std::ferror(file)) throw std::runtime_error("point_io: read failed");
+        owned.resize(used);
+        data = owned.data();
+        length = used;
+    }
+
+    input_buffer(const input_buffer &) = delete;
+
+    input_buffer &operator=(const input_buffer &) = delete;
+
+    ~input_buffer() {
+#ifdef VE281P1_POINT_IO_MMAP
+        if (mapped) munmap(const_cast<char *>(data), length);
+#endif
+    }
+
+    const char *begin() const { return data; }
+
+    const char *end() const { return data + length; }
+};
+
+// whitespace separated decimal integers of [first, last)
+class integer_parser {
+    const char *cursor;
+    const char *last;
+
+public:
+    integer_parser(const char *first, const char *last) : cursor(first), last(last) {}
+
+    // false at the end of the input, throws on anything that is not an integer fitting long long
+    bool next(long long &value) {
+        while (cursor != last && (*cursor == ' ' || *cursor == '\n' || *cursor == '\r' || *cursor == '\t')) cursor++;
+        if (cursor == last) return false;
+        bool negative = *cursor == '-';
+        if (negative || *cursor == '+') cursor++;
+        const char *digits = cursor;
+        unsigned long long magnitude = 0;
+        const unsigned long long limit = negative ? 9223372036854775808ull : 9223372036854775807ull;
+        while (cursor != last && (unsigned) (*cursor - '0') < 10) {
+            unsigned digit = (unsigned) (*cursor++ - '0');
+            if (magnitude > (limit - digit) / 10) throw std::runtime_error("point_io: integer out of range");
+            magnitude = magnitude * 10 + digit;
+        }
+        if (cursor == digits) throw std::runtime_error("point_io: expected an integer");
+        value = negative ? (long long) (0 - magnitude) : (long long) magnitude;
+        return true;
+    }
+
+    // bytes not parsed yet
+    size_t remaining() const { return (size_t) (last - cursor); }
+};
+
+template<typename Point>
+std::vector<Point> read_points_text(const char *first, const char *last) {
+    integer_parser parser(first, last);
+    long long count;
+    if (!parser.next(count)) return {};
+    if (count < 0) throw std::runtime_error("point_io: negative point count");
+    // every point takes at least four bytes (" x y"), so a larger count can not be met and is not allocated
+    if ((unsigned long long) count > parser.remaining() / 4) throw std::runtime_error("point_io: fewer points than announced");
+    std::vector<Point> points((size_t) count);
+    for (auto &point: points) {
+        long long x, y;
+        if (!parser.next(x) || !parser.next(y)) throw std::runtime_error("point_io: fewer points than announced");
+        point.x = x;
+        point.y = y;
+    }
+    return points;
+}
+
+template<typename Point>
+std::vector<Point> read_points_binary(const char *first, const char *last) {
+    size_t length = (size_t) (last - first);
+    uint64_t count;
+    if (length < sizeof(POINT_FILE_MAGIC) + sizeof(count) || std::memcmp(first, POINT_FILE_MAGIC, sizeof(POINT_FILE_MAGIC)) != 0)
+        throw std::runtime_error("point_io: not a binary point file");
+    std::memcpy(&count, first + sizeof(POINT_FILE_MAGIC), sizeof(count));
+    const char *records = first + sizeof(POINT_FILE_MAGIC) + sizeof(count);
+    if (count > (uint64_t) (last - records) / (2 * sizeof(int64_t))) throw std::runtime_error("point_io: truncated binary point file");
+    std::vector<Point> points((size_t) count);
+    for (size_t i = 0; i < points.size(); i++) {
+        int64_t coordinate[2];
+        std::memcpy(coordinate, records + i * sizeof(coordinate), sizeof(coordinate));
+        points[i].x = coordinate[0];
+        points[i].y = coordinate[1];
+    }
+    return points;
+}
+
+// binary when the input starts with POINT_FILE_MAGIC, text otherwise
+template<typename Point>
+std::vector<Point> read_points(const char *first, const char *last) {
+    if ((size_t) (last - first) >= sizeof(POINT_FILE_MAGIC) && std::memcmp(first, POINT_FILE_MAGIC, sizeof(POINT_FILE_MAGIC)) == 0)
+        return read_points_binary<Point>(first, last);
+    return read_points_text<Point>(first, last);
+}
+
+// formats into a block and hands the file only full blocks;
+// call flush() at the end to see write errors, the destructor only writes what is left and can not report them
+class output_buffer {
+    std::FILE *file;
+    std::vector<char> buffer;
+    size_t used = 0;
+
+public:
+    explicit output_buffer(std::FILE *file) : file(file), buffer(POINT_IO_BLOCK_BYTES) {}
+
+    output_buffer(const output_buffer &) = delete;
+
+    output_buffer &operator=(const output_buffer &) = delete;
+
+    ~output_buffer() {
+        if (used > 0) std::fwrite(buffer.data(), 1, used, file);
+    }
+
+    void flush() {
+        if (used > 0 && std::fwrite(buffer.data(), 1, used, file) != used) throw std::runtime_error("point_io: write failed");
+        used = 0;
+    }
+
+    void put(char c) {
+        if (used == buffer.size()) flush();
+        buffer[used++] = c;
+    }
+
+    void put(const void *bytes, size_t size) {
+        if (used + size > buffer.size()) flush();
+        if (size > buffer.size()) {
+            if (std::fwrite(bytes, 1, size, file) != size) throw std::runtime_error("point_io: write failed");
+            return;
+        }
+        std::memcpy(buffer.data() + used, bytes, size);
+        used += size;
+    }
+
+    void put(long long value) {
+        char digits[24];
+        char *end = digits + sizeof(digits);
+        char *p = end;
+        unsigned long long magnitude = value < 0 ? 0 - (unsigned long long) value : (unsigned long long) value;
+        do {
+            *--p = char('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude > 0);
+        if (value < 0) *--p = '-';
+        put(p, (size_t) (end - p));
+    }
+};
+
+// x y on a line for every point of points[index[0]], points[index[1]], ...
+template<typename Point>
+void write_points_text(output_buffer &out, const Point *points, const std::vector<size_t> &index) {
+    for (size_t i: index) {
+        out.put((long long) points[i].x);
+        out.put(' ');
+        out.put((long long) points[i].y);
+        out.put('\n');
+    }
+}
+
+template<typename Point>
+void write_points_binary(output_buffer &out, const Point *points, size_t size) {
+    uint64_t count = size;
+    out.put(POINT_FILE_MAGIC, sizeof(POINT_FILE_MAGIC));
+    out.put(&count, sizeof(count));
+    for (size_t i = 0; i < size; i++) {
+        int64_t coordinate[2] = {(int64_t) points[i].x, (int64_t) points[i].y};
+        out.put(coordinate, sizeof(coordinate));
+    }
+}
+
+#endif //VE281P1_POINT_IO_HPP
@@ -0,0 +1,115 @@
+#ifndef VE281P1_SLIDING_HULL_HPP
+#define VE281P1_SLIDING_HULL_HPP
+
+#include "hull.hpp"
+#include "incremental_hull.hpp"
+#include <vector>
+#include <stdexcept>
+
+/**
+ * Convex hull of a sliding window over a stream: points arrive at the back and expire at the front, by count
+ * (keep_last) or by time stamp (expire_before).
+ *
+ * The window is a queue made of two stacks. Arrivals go to the back stack and into an incremental_hull of it.
+ * When the front stack runs empty the back stack is moved over, newest point first, into a second pair of hull
+ * chains that log the vertices every insertion erases; the oldest point is then the last one inserted, and
+ * expiring it takes that insertion back. Every point is inserted and taken back at most once on each side, so a
+ * push or an expiry costs O(log W) amortized for a window of W points.
+ * The hull of the window is the hull of the vertices of both sides, O(h log h) for h such vertices.
+ */
+
+template<typename Point, typename Time = double>
+class sliding_hull {
+    struct back_entry {
+        Point point;
+        Time time;
+    };
+
+    // one point of the front stack and how to take its insertion back
+    struct front_entry {
+        Point point;
+        Time time;
+        bool upper, lower; // whether the point went into the chains
+        size_t upper_log, lower_log; // where its erased vertices start in the logs
+    };
+
+    std::vector<back_entry> back;
+    incremental_hull<Point> back_hull;
+    std::vector<front_entry> front; // the oldest point on top
+    hull_chain<Point, true> front_upper;
+    hull_chain<Point, false> front_lower;
+    std::vector<Point> upper_log, lower_log;
+
+    void refill() {
+        for (size_t i = back.size(); i-- > 0;) {
+            front_entry entry{back[i].point, back[i].time, false, false, upper_log.size(), lower_log.size()};
+            entry.upper = front_upper.insert(entry.point, &upper_log);
+            entry.lower = front_lower.insert(entry.point, &lower_log);
+            front.push_back(entry);
+        }
+        back.clear();
+        back_hull.clear();
+    }
+
+public:
+    void push(const Point &point, Time time = Time()) {
+        back.push_back({point, time});
+        back_hull.insert(point);
+    }
+
+    // drops the oldest point
+    void pop() {
+        if (front.empty()) {
+            if (back.empty()) throw std::runtime_error("sliding_hull: pop from an empty window");
+            refill();
+        }
+        const front_entry &entry = front.back();
+        if (entry.upper) front_upper.undo(entry.point, upper_log.data() + entry.upper_log, upper_log.data() + upper_log.size());
+        if (entry.lower) front_lower.undo(entry.point, lower_log.data() + entry.lower_log, lower_log.data() + lower_log.size());
+        upper_log.resize(entry.upper_log);
+        lower_log.resize(entry.lower_log);
+        front.pop_back();
+    }
+
+    size_t size() const { return front.size() + back.size(); }
+
+    bool empty() const { return size() == 0; }
+
+    const Time &oldest_time() const {
+        if (empty()) throw std::runtime_error("sliding_hull: empty window");
+        return front.empty() ? back.front().time : front.back().time;
+    }
+
+    // the last count points stay
+    void keep_last(size_t count) {
+        while (size() > count) pop();
+    }
+
+    // the points stamped cutoff or later stay, expire_before(now - T) keeps the last T seconds
+    void expire_before(const Time &cutoff) {
+        while (!empty() && oldest_time() < cutoff) pop();
+    }
+
+    // the hull of the window, counter-clockwise from the lowest point like convex_hull of hull.hpp
+    std::vector<Point> vertices() const {
+        std::vector<Point> candidates;
+        for (auto &vertex: front_upper) candidates.push_back(vertex.second);
+        for (auto &vertex: front_lower) candidates.push_back(vertex.second);
+        back_hull.for_each_vertex([&candidates](const Point &vertex) { candidates.push_back(vertex); });
+        std::vector<Point> hull;
+        for (size_t i: convex_hull(candidates)) hull.push_back(candidates[i]);
+        return hull;
+    }
+
+    void clear() {
+        back.clear();
+        back_hull.clear();
+        front.clear();
+        front_upper.clear();
+        front_lower.clear();
+        upper_log.clear();
+        lower_log.clear();
+    }
+};
+
+#endif //VE281P1_SLIDING_HULL_HPP
@@ -2,6 +2,164 @@
 #define VE281P1_SORT_HPP
 
 #include <vector>
+#include <deque>
+#include <algorithm>
+#include <utility>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <climits>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include "sort_simd.hpp"
+#include "sort_stats.hpp"
+
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+// a small work-stealing pool: each worker pushes/pops at the back of its own deque,
+// idle workers steal from the front of the others, threads outside the pool share the last deque
+class sort_thread_pool {
+    struct task_queue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+    std::vector<std::unique_ptr<task_queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopped{false};
+    std::atomic<size_t> queued{0};
+    std::mutex sleep_lock;
+    std::condition_variable sleep_cv;
+
+    static sort_thread_pool *&current_pool() {
+        static thread_local sort_thread_pool *pool = nullptr;
+        return pool;
+    }
+
+    static size_t &current_index() {
+        static thread_local size_t index = 0;
+        return index;
+    }
+
+    size_t home() const {
+        return current_pool() == this ? current_index() : queues.size() - 1;
+    }
+
+    bool try_run_one() {
+        size_t self = home();
+        size_t count = queues.size();
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> guard(queues[self]->lock);
+            if (!queues[self]->tasks.empty()) {
+                task = std::move(queues[self]->tasks.back());
+                queues[self]->tasks.pop_back();
+            }
+        }
+        for (size_t k = 1; !task && k < count; k++) { // steal the oldest (largest) task of someone else
+            task_queue &victim = *queues[(self + k) % count];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+        }
+        if (!task) return false;
+        queued--;
+        task();
+        // a finished task may be what wait() sleeps on; the lock orders this after its check of pending
+        { std::lock_guard<std::mutex> guard(sleep_lock); }
+        sleep_cv.notify_all();
+        return true;
+    }
+
+    void worker_loop(size_t index) {
+        current_pool() = this;
+        current_index() = index;
+        while (!stopped) {
+            if (try_run_one()) continue;
+            std::unique_lock<std::mutex> guard(sleep_lock);
+            sleep_cv.wait(guard, [this] { return stopped || queued > 0; });
+        }
+    }
+
+public:
+    explicit sort_thread_pool(size_t threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i <= threads; i++) queues.emplace_back(new task_queue);
+        for (size_t i = 0; i < threads; i++) workers.emplace_back(&sort_thread_pool::worker_loop, this, i);
+    }
+
+    sort_thread_pool(const sort_thread_pool &) = delete;
+
+    sort_thread_pool &operator=(const sort_thread_pool &) = delete;
+
+    ~sort_thread_pool() {
+        {
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            stopped = true;
+        }
+        sleep_cv.notify_all();
+        for (auto &worker: workers) worker.join();
+    }
+
+    size_t size() const { return workers.size(); }
+
+    void submit(std::function<void()> task) {
+        {
+            task_queue &queue = *queues[home()];
+            std::lock_guard<std::mutex> guard(queue.lock);
+            queue.tasks.push_back(std::move(task));
+        }
+        {
+            // counted under sleep_lock so a worker between its check and its wait cannot miss the notification
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            queued++;
+        }
+        sleep_cv.notify_one();
+    }
+
+    // help running tasks until every task counted by pending has finished
+    void wait(const std::atomic<size_t> &pending) {
+        while (pending > 0) {
+            if (try_run_one()) continue;
+            std::unique_lock<std::mutex> guard(sleep_lock);
+            sleep_cv.wait(guard, [this, &pending] { return pending == 0 || queued > 0; });
+        }
+    }
+
+    // run body(0) ... body(count - 1) on the pool and the calling thread, returns when all of them are done
+    template<typename Body>
+    void parallel_for(size_t count, const Body &body) {
+        if (count == 0) return;
+        std::atomic<size_t> pending{count - 1};
+        for (size_t index = 1; index < count; index++) {
+            submit([&body, &pending, index] {
+                body(index);
+                pending--;
+            });
+        }
+        body(0);
+        wait(pending);
+    }
+
+    static sort_thread_pool &shared() {
+        static sort_thread_pool pool;
+        return pool;
+    }
+};
+
+// ranges smaller than this are not worth a task, they are sorted serially
+constexpr int PARALLEL_SORT_CUTOFF = 1 << 14;
 
 template<typename T, typename Compare>
 void bubble_sort(std::vector<T> &vector, Compare comp = std::less<T>()) {
@@ -56,10 +214,11 @@ void selection_sort(std::vector<T> &vector, Compare comp = std::less<T>()) {
 }
 
 template<typename T, typename Compare>
-void merge_helper(std::vector<T> &vector,int left, int mid, int right, Compare comp = std::less<T>()){
-    int i = left;
-    int j = mid + 1;
+void merge_helper(std::vector<T> &vector, size_t left, size_t mid, size_t right, Compare comp = std::less<T>()){
+    size_t i = left;
+    size_t j = mid + 1;
     std::vector<T> temp;
+    VE281P1_SORT_STATS_ALLOCATION(1);
     while(i < mid + 1 && j <= right){
         if (!comp(vector[j],vector[i])){
             temp.push_back(vector[i]);
@@ -83,11 +242,11 @@ void merge_helper(std::vector<T> &vector,int left, int mid, int right, Compare c
         }
     }
     j--;
-    int pos = (int)temp.size()-  1;
+    size_t pos = temp.size() - 1;
     bool is_empty = temp.empty();
     while(!is_empty){
+        vector[j] = temp[pos]; // before pop_back destroys it
         temp.pop_back();
-        vector[j] = temp[pos];
         j--;
         pos--;
         is_empty = temp.empty();
@@ -95,9 +254,10 @@ void merge_helper(std::vector<T> &vector,int left, int mid, int right, Compare c
 }
 
 template<typename T, typename Compare>
-void merge_sort_helper(std::vector<T> &vector, int left, int right, Compare comp = std::less<T>()){
+void merge_sort_helper(std::vector<T> &vector, size_t left, size_t right, Compare comp = std::less<T>()){
+    VE281P1_SORT_STATS_DEPTH();
     if (left >= right) return;
-    int mid = (left + right) / 2;
+    size_t mid = left + (right - left) / 2;
     merge_sort_helper(vector, left, mid, comp);
     merge_sort_helper(vector, mid + 1, right, comp);
     merge_helper(vector, left, mid, right, comp);
@@ -106,8 +266,147 @@ void merge_sort_helper(std::vector<T> &vector, int left, int right, Compare comp
 template<typename T, typename Compare>
 void merge_sort(std::vector<T> &vector, Compare comp = std::less<T>()) {
     // TODO: implement
-    int length = (int)vector.size();
-    merge_sort_helper(vector, 0, length - 1, comp);
+    if (vector.size() < 2) return;
+    merge_sort_helper(vector, 0, vector.size() - 1, comp);
+}
+
+// merge the sorted runs [first, mid) and [mid, last) into target by moving, returns the end of the output
+template<typename InputIt, typename OutputIt, typename Compare>
+OutputIt merge_move(InputIt first, InputIt mid, InputIt last, OutputIt target, Compare comp){
+    InputIt i = first;
+    InputIt j = mid;
+    while (i != mid && j != last){
+        if (!comp(*j, *i)) *target++ = std::move(*i++);
+        else *target++ = std::move(*j++);
+    }
+    target = std::move(i, mid, target);
+    return std::move(j, last, target);
+}
+
+// bottom-up merge sort of [first, last) that ping-pongs between the range and buffer[0, last - first)
+template<typename RandomIt, typename BufferIt, typename Compare>
+void merge_sort_range(RandomIt first, RandomIt last, BufferIt buffer, Compare comp) {
+    typedef typename std::iterator_traits<RandomIt>::difference_type Index;
+    Index length = last - first;
+    bool in_buffer = false;
+    for (Index width = 1; width < length; width *= 2){
+        for (Index low = 0; low < length; low += 2 * width){
+            Index mid = std::min(low + width, length);
+            Index high = std::min(low + 2 * width, length);
+            if (in_buffer) merge_move(buffer + low, buffer + mid, buffer + high, first + low, comp);
+            else merge_move(first + low, first + mid, first + high, buffer + low, comp);
+        }
+        in_buffer = !in_buffer;
+    }
+    if (in_buffer) std::move(buffer, buffer + length, first);
+}
+
+// buffer is grown to vector.size() once and can be reused across calls to avoid any further allocation
+template<typename T, typename Compare>
+void merge_sort(std::vector<T> &vector, std::vector<T> &buffer, Compare comp = std::less<T>()) {
+    if (buffer.size() < vector.size()){
+        VE281P1_SORT_STATS_ALLOCATION(1);
+        buffer.resize(vector.size());
+    }
+    merge_sort_range(vector.begin(), vector.end(), buffer.begin(), comp);
+}
+
+template<typename RandomIt, typename Compare = std::less<typename std::iterator_traits<RandomIt>::value_type>>
+void merge_sort_buffered(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    std::vector<typename std::iterator_traits<RandomIt>::value_type> buffer((size_t)(last - first));
+    VE281P1_SORT_STATS_ALLOCATION(1);
+    merge_sort_range(first, last, buffer.begin(), comp);
+}
+
+template<typename T, typename Compare>
+void merge_sort_buffered(std::vector<T> &vector, Compare comp = std::less<T>()) {
+    merge_sort_buffered(vector.begin(), vector.end(), comp);
+}
+
+// number of elements of the merged runs a[0, a_size) and b[0, b_size) that come from a
+// among the first k outputs of a stable merge (ties are taken from a first)
+template<typename RandomIt, typename Compare>
+size_t co_rank(size_t k, RandomIt a, size_t a_size, RandomIt b, size_t b_size, Compare comp){
+    size_t low = k > b_size ? k - b_size : 0;
+    size_t high = std::min(k, a_size);
+    while (low < high){
+        size_t i = low + (high - low) / 2;
+        size_t j = k - i;
+        if (j > 0 && !comp(b[j - 1], a[i])) low = i + 1; // a[i] still precedes b[j - 1]
+        else high = i;
+    }
+    return low;
+}
+
+// merge source[left, mid] and source[mid + 1, right] into target[left, right], splitting the output into
+// independent slices whose split points are found by co-ranking
+template<typename SourceIt, typename TargetIt, typename Compare>
+void parallel_merge_move(SourceIt source, TargetIt target, size_t left, size_t mid, size_t right,
+                         Compare comp, sort_thread_pool &pool){
+    SourceIt a = source + left;
+    SourceIt b = source + mid + 1;
+    size_t a_size = mid + 1 - left;
+    size_t b_size = right - mid;
+    size_t total = a_size + b_size;
+    size_t slices = std::min(pool.size() + 1, total / PARALLEL_SORT_CUTOFF);
+    if (slices < 2){
+        merge_move(a, b, source + right + 1, target + left, comp);
+        return;
+    }
+    auto merge_slice = [&, a, b, a_size, b_size, total, slices](size_t slice){
+        size_t out_begin = total * slice / slices;
+        size_t out_end = total * (slice + 1) / slices;
+        size_t i = co_rank(out_begin, a, a_size, b, b_size, comp);
+        size_t j = out_begin - i;
+        size_t i_end = co_rank(out_end, a, a_size, b, b_size, comp);
+        size_t j_end = out_end - i_end;
+        TargetIt out = target + left + out_begin;
+        while (i < i_end && j < j_end){
+            if (!comp(b[j], a[i])) *out++ = std::move(a[i++]);
+            else *out++ = std::move(b[j++]);
+        }
+        out = std::move(a + i, a + i_end, out);
+        std::move(b + j, b + j_end, out);
+    };
+    pool.parallel_for(slices, merge_slice);
+}
+
+// sort data[left, right] and leave the result in data or buffer (into_buffer),
+// the halves are sorted into the other one so every level moves the elements exactly once
+template<typename RandomIt, typename BufferIt, typename Compare>
+void parallel_merge_sort_helper(RandomIt data, BufferIt buffer, size_t left, size_t right,
+                                bool into_buffer, Compare comp, sort_thread_pool &pool){
+    VE281P1_SORT_STATS_DEPTH();
+    if (right - left + 1 <= (size_t)PARALLEL_SORT_CUTOFF){
+        merge_sort_range(data + left, data + right + 1, buffer + left, comp);
+        if (into_buffer) std::move(data + left, data + right + 1, buffer + left);
+        return;
+    }
+    size_t mid = left + (right - left) / 2;
+    std::atomic<size_t> pending{1};
+    pool.submit([data, buffer, left, mid, into_buffer, comp, &pool, &pending]{
+        parallel_merge_sort_helper(data, buffer, left, mid, !into_buffer, comp, pool);
+        pending--;
+    });
+    parallel_merge_sort_helper(data, buffer, mid + 1, right, !into_buffer, comp, pool);
+    pool.wait(pending);
+    if (into_buffer) parallel_merge_move(data, buffer, left, mid, right, comp, pool);
+    else parallel_merge_move(buffer, data, left, mid, right, comp, pool);
+}
+
+// stable parallel merge sort, both the recursion and the merges are split across the shared pool
+template<typename RandomIt, typename Compare = std::less<typename std::iterator_traits<RandomIt>::value_type>>
+void parallel_merge_sort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    size_t length = (size_t)(last - first);
+    if (length < 2) return;
+    std::vector<typename std::iterator_traits<RandomIt>::value_type> buffer(length);
+    VE281P1_SORT_STATS_ALLOCATION(1);
+    parallel_merge_sort_helper(first, buffer.begin(), 0, length - 1, false, comp, sort_thread_pool::shared());
+}
+
+template<typename T, typename Compare>
+void parallel_merge_sort(std::vector<T> &vector, Compare comp = std::less<T>()) {
+    parallel_merge_sort(vector.begin(), vector.end(), comp);
 }
 
 template<typename T, typename Compare>
@@ -116,6 +415,7 @@ int partition_extra(std::vector<T> &vector, int left, int right, Compare comp =
     std::vector<T> front;
     std::vector<T> back;
     std::vector<T> temp;
+    VE281P1_SORT_STATS_ALLOCATION(3);
     for(int i = left + 1; i <= right; i++){
         if (comp(vector[i], vector[left])){
             front.push_back(vector[i]);
@@ -140,11 +440,13 @@ int partition_extra(std::vector<T> &vector, int left, int right, Compare comp =
     for (int i = left; i <= right; i++){
         vector[i] = temp[i - left];
     }
+    VE281P1_SORT_STATS_PARTITION(pos - left, right - pos);
     return pos;
 }
 
 template<typename T, typename Compare>
 void quick_sort_extra_helper(std::vector<T> &vector,int left, int right, Compare comp = std::less<T>()){
+    VE281P1_SORT_STATS_DEPTH();
     int pivot;
     if (left >= right) return;
     pivot = partition_extra(vector, left, right, comp);
@@ -160,48 +462,851 @@ void quick_sort_extra(std::vector<T> &vector, Compare comp = std::less<T>()) {
 }
 
 
-template<typename T, typename Compare>
-int partition_inplace(std::vector<T> &vector, int left, int right, Compare comp = std::less<T>()) {
-    int i = left + 1;
-    int j = right;
+// partition [first, last) around the pivot *first, returns where the pivot ends up
+template<typename RandomIt, typename Compare>
+RandomIt partition_inplace(RandomIt first, RandomIt last, Compare comp) {
+    typename std::iterator_traits<RandomIt>::difference_type i = 1;
+    auto j = last - first - 1;
     while(i <= j){
-        while(comp(vector[i], vector[left]) && (i < j)){
+        while(comp(first[i], *first) && (i < j)){
             i++;
         }
-        while(!comp(vector[j], vector[left]) && (i < j)){
+        while(!comp(first[j], *first) && (i < j)){
             j--;
         }
         if (i < j){
-            T temp = vector[i];
-            vector[i] = vector[j];
-            vector[j] = temp;
-
+            std::iter_swap(first + i, first + j);
         }
         i++;
         j--;
     }
     j++;
-    if(!comp(vector[j], vector[left])) j--;
-    T temp = vector[left];
-    vector[left] = vector[j];
-    vector[j] = temp;
-    return j;
+    if(!comp(first[j], *first)) j--;
+    std::iter_swap(first, first + j);
+    VE281P1_SORT_STATS_PARTITION(j, last - first - j - 1);
+    return first + j;
 }
 
 template<typename T, typename Compare>
-void quick_sort_inplace_helper(std::vector<T> &vector, int left, int right, Compare comp = std::less<T>()){
-    int pivot;
-    if (left >= right) return;
-    pivot = partition_inplace(vector, left, right, comp);
-    quick_sort_inplace_helper(vector, left, pivot - 1, comp);
-    quick_sort_inplace_helper(vector, pivot + 1, right, comp);
+size_t partition_inplace(std::vector<T> &vector, size_t left, size_t right, Compare comp = std::less<T>()) {
+    return (size_t)(partition_inplace(vector.begin() + left, vector.begin() + right + 1, comp) - vector.begin());
+}
+
+template<typename RandomIt, typename Compare>
+void quick_sort_inplace_helper(RandomIt first, RandomIt last, Compare comp){
+    VE281P1_SORT_STATS_DEPTH();
+    if (last - first < 2) return;
+    RandomIt pivot = partition_inplace(first, last, comp);
+    quick_sort_inplace_helper(first, pivot, comp);
+    quick_sort_inplace_helper(pivot + 1, last, comp);
 }
 
 template<typename T, typename Compare>
 void quick_sort_inplace(std::vector<T> &vector, Compare comp = std::less<T>()) {
     // TODO: implement
-    int length = (int)vector.size();
-    quick_sort_inplace_helper(vector, 0, length - 1, comp);
+    quick_sort_inplace_helper(vector.begin(), vector.end(), comp);
+}
+
+// partitions this small are finished by insertion sort
+constexpr int INTRO_SORT_THRESHOLD = 16;
+
+template<typename RandomIt, typename Compare>
+void insertion_sort_range(RandomIt first, RandomIt last, Compare comp){
+    if (first == last) return;
+    for (RandomIt i = first + 1; i != last; ++i){
+        auto temp = std::move(*i);
+        RandomIt j = i;
+        for (; j != first && comp(temp, *(j - 1)); --j) *j = std::move(*(j - 1));
+        *j = std::move(temp);
+    }
+}
+
+// iterators whose elements are known to sit back to back in memory
+template<typename RandomIt>
+struct is_contiguous_iterator : std::integral_constant<bool, std::is_pointer<RandomIt>::value ||
+        std::is_same<RandomIt, typename std::vector<typename std::iterator_traits<RandomIt>::value_type>::iterator>::value> {};
+
+// simd_sort over an iterator pair: contiguous ranges are sorted in place, others through a buffer
+template<typename RandomIt>
+void simd_sort(RandomIt first, RandomIt last) {
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    if (last - first < 2) return;
+    if constexpr (is_contiguous_iterator<RandomIt>::value) {
+        simd_sort(&*first, &*first + (last - first));
+    }
+    else {
+        std::vector<T> buffer(first, last);
+        VE281P1_SORT_STATS_ALLOCATION(1);
+        simd_sort(buffer.data(), buffer.data() + buffer.size());
+        std::copy(buffer.begin(), buffer.end(), first);
+    }
+}
+
+// finish a small partition, with a SIMD sorting network when the type and order allow it
+template<typename RandomIt, typename Compare>
+void sort_small_range(RandomIt first, RandomIt last, Compare comp){
+    if (last - first < 2) return; // also keeps &*first below off empty ranges
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    if constexpr (is_simd_sortable<T>::value && std::is_same<Compare, std::less<T>>::value &&
+                  is_contiguous_iterator<RandomIt>::value){
+        if ((size_t)(last - first) <= SIMD_NETWORK_SIZE){
+            simd_sort_small(&*first, (size_t)(last - first));
+            return;
+        }
+    }
+    insertion_sort_range(first, last, comp);
+}
+
+template<typename RandomIt, typename Compare>
+void sift_down(RandomIt first, typename std::iterator_traits<RandomIt>::difference_type root,
+               typename std::iterator_traits<RandomIt>::difference_type size, Compare comp){
+    auto temp = std::move(first[root]);
+    auto child = 2 * root + 1;
+    while (child < size){
+        if (child + 1 < size && comp(first[child], first[child + 1])) child++;
+        if (!comp(temp, first[child])) break;
+        first[root] = std::move(first[child]);
+        root = child;
+        child = 2 * root + 1;
+    }
+    first[root] = std::move(temp);
+}
+
+template<typename RandomIt, typename Compare>
+void heap_sort_range(RandomIt first, RandomIt last, Compare comp){
+    auto size = last - first;
+    for (auto i = size / 2 - 1; i >= 0; i--) sift_down(first, i, size, comp);
+    for (auto end = size - 1; end > 0; end--){
+        std::iter_swap(first, first + end);
+        sift_down(first, 0, end, comp);
+    }
+}
+
+template<typename RandomIt, typename Compare>
+RandomIt median_of_three(RandomIt a, RandomIt b, RandomIt c, Compare comp){
+    if (comp(*a, *b)){
+        if (comp(*b, *c)) return b;
+        return comp(*a, *c) ? c : a;
+    }
+    if (comp(*a, *c)) return a;
+    return comp(*b, *c) ? c : b;
+}
+
+// median-of-three for mid-sized ranges, Tukey's ninther for large ones, moved to the front of the range
+template<typename RandomIt, typename Compare>
+void choose_pivot_to_left(RandomIt first, RandomIt last, Compare comp){
+    auto size = last - first;
+    RandomIt mid = first + size / 2;
+    RandomIt back = last - 1;
+    RandomIt pivot;
+    if (size > 128){
+        auto step = size / 8;
+        RandomIt a = median_of_three(first, first + step, first + 2 * step, comp);
+        RandomIt b = median_of_three(mid - step, mid, mid + step, comp);
+        RandomIt c = median_of_three(back - 2 * step, back - step, back, comp);
+        pivot = median_of_three(a, b, c, comp);
+    }
+    else pivot = median_of_three(first, mid, back, comp);
+    std::iter_swap(first, pivot);
+}
+
+template<typename RandomIt, typename Compare>
+void intro_sort_helper(RandomIt first, RandomIt last, int depth_limit, Compare comp){
+    VE281P1_SORT_STATS_DEPTH();
+    while (last - first > INTRO_SORT_THRESHOLD){
+        if (depth_limit == 0){ // too many bad pivots, heap sort keeps the O(nlogn) bound
+            heap_sort_range(first, last, comp);
+            return;
+        }
+        depth_limit--;
+        choose_pivot_to_left(first, last, comp);
+        RandomIt pivot = partition_inplace(first, last, comp);
+        // recurse into the smaller side, loop on the larger one to bound the stack
+        if (pivot - first < last - pivot){
+            intro_sort_helper(first, pivot, depth_limit, comp);
+            first = pivot + 1;
+        }
+        else {
+            intro_sort_helper(pivot + 1, last, depth_limit, comp);
+            last = pivot;
+        }
+    }
+    sort_small_range(first, last, comp);
+}
+
+template<typename Index>
+int intro_sort_depth_limit(Index size){
+    int depth_limit = 0;
+    for (; size > 1; size >>= 1) depth_limit += 2;
+    return depth_limit;
+}
+
+template<typename RandomIt, typename Compare = std::less<typename std::iterator_traits<RandomIt>::value_type>>
+void intro_sort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    intro_sort_helper(first, last, intro_sort_depth_limit(last - first), comp);
+}
+
+template<typename T, typename Compare>
+void intro_sort(std::vector<T> &vector, Compare comp = std::less<T>()) {
+    intro_sort(vector.begin(), vector.end(), comp);
+}
+
+// Dutch national flag partition around the pivot at *first, no auxiliary storage:
+// returns the range of the elements equivalent to the pivot, the ones before it are less and the ones after greater
+template<typename RandomIt, typename Compare>
+std::pair<RandomIt, RandomIt> partition_three_way(RandomIt first, RandomIt last, Compare comp){
+    auto pivot = *first;
+    RandomIt lt = first;
+    RandomIt i = first + 1;
+    RandomIt gt = last;
+    while (i < gt){
+        if (comp(*i, pivot)) std::iter_swap(lt++, i++);
+        else if (comp(pivot, *i)) std::iter_swap(i, --gt);
+        else ++i;
+    }
+    VE281P1_SORT_STATS_PARTITION(lt - first, last - gt);
+    return std::make_pair(lt, gt);
+}
+
+template<typename RandomIt, typename Compare>
+void parallel_quick_sort_inplace_helper(RandomIt first, RandomIt last, int depth_limit, Compare comp,
+                                        sort_thread_pool &pool, std::atomic<size_t> &pending){
+    VE281P1_SORT_STATS_DEPTH();
+    // past the depth limit the pivots keep going bad, intro sort below keeps the O(nlogn) bound
+    while (last - first > PARALLEL_SORT_CUTOFF && depth_limit > 0){
+        depth_limit--;
+        choose_pivot_to_left(first, last, comp);
+        // three-way, so runs of equal keys are settled here instead of being peeled off one element per pass
+        std::pair<RandomIt, RandomIt> equal = partition_three_way(first, last, comp);
+        // hand the smaller side to the pool and keep partitioning the larger one
+        RandomIt task_first = first, task_last = equal.first;
+        if (equal.first - first > last - equal.second) {
+            task_first = equal.second;
+            task_last = last;
+            last = equal.first;
+        }
+        else first = equal.second;
+        if (task_last - task_first < 2) continue;
+        pending++;
+        pool.submit([task_first, task_last, depth_limit, comp, &pool, &pending]{
+            parallel_quick_sort_inplace_helper(task_first, task_last, depth_limit, comp, pool, pending);
+            pending--;
+        });
+    }
+    // serial leaves go through intro sort, a first-element pivot would go quadratic on presorted leaves
+    intro_sort_helper(first, last, intro_sort_depth_limit(last - first), comp);
+}
+
+template<typename RandomIt, typename Compare = std::less<typename std::iterator_traits<RandomIt>::value_type>>
+void parallel_quick_sort_inplace(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    if (last - first <= PARALLEL_SORT_CUTOFF) {
+        intro_sort(first, last, comp);
+        return;
+    }
+    sort_thread_pool &pool = sort_thread_pool::shared();
+    std::atomic<size_t> pending{0};
+    parallel_quick_sort_inplace_helper(first, last, intro_sort_depth_limit(last - first), comp, pool, pending);
+    pool.wait(pending);
+}
+
+template<typename T, typename Compare>
+void parallel_quick_sort_inplace(std::vector<T> &vector, Compare comp = std::less<T>()) {
+    parallel_quick_sort_inplace(vector.begin(), vector.end(), comp);
+}
+
+// random samples drawn per thread to pick the sample sort splitters
+constexpr size_t SAMPLE_SORT_OVERSAMPLING = 64;
+
+// Parallel sample sort. Splitters are picked from a sorted random oversample, then in one parallel pass every
+// thread classifies its contiguous block of the input, and in a second one scatters the block into the buckets
+// of a buffer at offsets from a prefix sum, so no two threads write the same place. The buckets are then sorted
+// independently with intro_sort and moved back. Keys equal to a splitter go to their own bucket, which needs no
+// sorting, so heavy duplicates do not make one bucket huge.
+template<typename RandomIt, typename Compare = std::less<typename std::iterator_traits<RandomIt>::value_type>>
+void sample_sort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    size_t length = (size_t)(last - first);
+    sort_thread_pool &pool = sort_thread_pool::shared();
+    size_t blocks = pool.size() + 1;
+    if (blocks < 2 || length <= blocks * (size_t)PARALLEL_SORT_CUTOFF) {
+        intro_sort(first, last, comp);
+        return;
+    }
+
+    std::vector<T> sample;
+    sample.reserve(blocks * SAMPLE_SORT_OVERSAMPLING);
+    std::mt19937_64 random(length);
+    for (size_t i = 0; i < blocks * SAMPLE_SORT_OVERSAMPLING; i++) sample.push_back(first[random() % length]);
+    intro_sort(sample.begin(), sample.end(), comp);
+    std::vector<T> splitters;
+    for (size_t i = 1; i < blocks; i++) {
+        const T &candidate = sample[i * SAMPLE_SORT_OVERSAMPLING];
+        if (splitters.empty() || comp(splitters.back(), candidate)) splitters.push_back(candidate);
+    }
+    // bucket 2i holds the keys between splitter i - 1 and splitter i, bucket 2i + 1 the keys equal to splitter i
+    size_t buckets = 2 * splitters.size() + 1;
+    auto classify = [&splitters, &comp](const T &item) {
+        size_t index = (size_t)(std::lower_bound(splitters.begin(), splitters.end(), item, comp) - splitters.begin());
+        if (index < splitters.size() && !comp(item, splitters[index])) return (uint32_t)(2 * index + 1);
+        return (uint32_t)(2 * index);
+    };
+    auto block_begin = [length, blocks](size_t block) { return length * block / blocks; };
+
+    std::vector<uint32_t> bucket_of(length);
+    std::vector<size_t> offsets(blocks * buckets, 0);
+    pool.parallel_for(blocks, [&](size_t block) {
+        size_t *count = offsets.data() + block * buckets;
+        for (size_t i = block_begin(block); i < block_begin(block + 1); i++) {
+            bucket_of[i] = classify(first[i]);
+            count[bucket_of[i]]++;
+        }
+    });
+    std::vector<size_t> bucket_begin(buckets + 1);
+    size_t offset = 0;
+    for (size_t bucket = 0; bucket < buckets; bucket++) {
+        bucket_begin[bucket] = offset;
+        for (size_t block = 0; block < blocks; block++) {
+            size_t count = offsets[block * buckets + bucket];
+            offsets[block * buckets + bucket] = offset;
+            offset += count;
+        }
+    }
+    bucket_begin[buckets] = length;
+
+    std::vector<T> buffer(length);
+    VE281P1_SORT_STATS_ALLOCATION(5); // sample, splitters, bucket_of, offsets and buffer
+    pool.parallel_for(blocks, [&](size_t block) {
+        size_t *position = offsets.data() + block * buckets;
+        for (size_t i = block_begin(block); i < block_begin(block + 1); i++)
+            buffer[position[bucket_of[i]]++] = std::move(first[i]);
+    });
+    std::atomic<size_t> next_bucket{0};
+    pool.parallel_for(blocks, [&](size_t) {
+        for (size_t bucket = next_bucket++; bucket < buckets; bucket = next_bucket++) {
+            auto bucket_first = buffer.begin() + bucket_begin[bucket];
+            auto bucket_last = buffer.begin() + bucket_begin[bucket + 1];
+            if (bucket % 2 == 0) intro_sort(bucket_first, bucket_last, comp);
+            std::move(bucket_first, bucket_last, first + bucket_begin[bucket]);
+        }
+    });
+}
+
+template<typename T, typename Compare>
+void sample_sort(std::vector<T> &vector, Compare comp = std::less<T>()) {
+    sample_sort(vector.begin(), vector.end(), comp);
+}
+
+// allocation-free replacement for quick_sort_extra, runs of equal keys are settled in one pass
+template<typename RandomIt, typename Compare>
+void quick_sort_three_way_helper(RandomIt first, RandomIt last, Compare comp){
+    VE281P1_SORT_STATS_DEPTH();
+    while (last - first > 1){
+        choose_pivot_to_left(first, last, comp);
+        std::pair<RandomIt, RandomIt> equal = partition_three_way(first, last, comp);
+        // recurse into the smaller side, loop on the larger one to bound the stack
+        if (equal.first - first < last - equal.second){
+            quick_sort_three_way_helper(first, equal.first, comp);
+            first = equal.second;
+        }
+        else {
+            quick_sort_three_way_helper(equal.second, last, comp);
+            last = equal.first;
+        }
+    }
+}
+
+template<typename RandomIt, typename Compare = std::less<typename std::iterator_traits<RandomIt>::value_type>>
+void quick_sort_three_way(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    quick_sort_three_way_helper(first, last, comp);
+}
+
+template<typename T, typename Compare>
+void quick_sort_three_way(std::vector<T> &vector, Compare comp = std::less<T>()) {
+    quick_sort_three_way(vector.begin(), vector.end(), comp);
+}
+
+// Hoare's quickselect on partition_three_way: afterwards *nth is the element a full sort would put there,
+// nothing before it is greater and nothing after it is less. It stops as soon as nth lands among the elements
+// equivalent to the pivot, so many equal keys end it early instead of slowing it down. Expected O(n); like
+// intro sort it falls back to heap sort on the remaining range when the pivots keep going bad
+template<typename RandomIt, typename Compare = std::less<typename std::iterator_traits<RandomIt>::value_type>>
+void quick_select(RandomIt first, RandomIt nth, RandomIt last, Compare comp = Compare()) {
+    if (nth == last) return;
+    int depth_limit = intro_sort_depth_limit(last - first);
+    while (last - first > INTRO_SORT_THRESHOLD){
+        if (depth_limit-- == 0){
+            heap_sort_range(first, last, comp);
+            return;
+        }
+        choose_pivot_to_left(first, last, comp);
+        std::pair<RandomIt, RandomIt> equal = partition_three_way(first, last, comp);
+        if (nth < equal.first) last = equal.first;
+        else if (nth < equal.second) return;
+        else first = equal.second;
+    }
+    insertion_sort_range(first, last, comp);
+}
+
+template<typename T, typename Compare>
+void quick_select(std::vector<T> &vector, size_t nth, Compare comp = std::less<T>()) {
+    quick_select(vector.begin(), vector.begin() + (typename std::vector<T>::difference_type)std::min(nth, vector.size()), vector.end(), comp);
+}
+
+// the k smallest elements, sorted, at the front in O(n + k log k); the order of the rest is unspecified
+template<typename RandomIt, typename Compare = std::less<typename std::iterator_traits<RandomIt>::value_type>>
+void partial_sort_k(RandomIt first, RandomIt last, size_t k, Compare comp = Compare()) {
+    if (k == 0) return;
+    RandomIt middle = first + (typename std::iterator_traits<RandomIt>::difference_type)std::min(k, (size_t)(last - first));
+    if (middle != last) quick_select(first, middle, last, comp);
+    intro_sort(first, middle, comp);
+}
+
+template<typename T, typename Compare>
+void partial_sort_k(std::vector<T> &vector, size_t k, Compare comp = std::less<T>()) {
+    partial_sort_k(vector.begin(), vector.end(), k, comp);
+}
+
+// the k smallest elements seen in a stream, kept in a max-heap under comp so each push costs O(log k)
+template<typename T, typename Compare = std::less<T>>
+class top_k {
+    size_t k;
+    Compare comp;
+    std::vector<T> heap;
+
+public:
+    explicit top_k(size_t count, Compare order = Compare()) : k(count), comp(order) {
+        heap.reserve(k);
+    }
+
+    void push(const T &item) {
+        if (heap.size() < k) {
+            heap.push_back(item);
+            std::push_heap(heap.begin(), heap.end(), comp);
+        }
+        else if (k > 0 && comp(item, heap.front())) {
+            heap.front() = item;
+            sift_down(heap.begin(), 0, (typename std::vector<T>::difference_type)heap.size(), comp);
+        }
+    }
+
+    template<typename InputIt>
+    void push(InputIt first, InputIt last) {
+        for (; first != last; ++first) push(*first);
+    }
+
+    size_t size() const { return heap.size(); }
+
+    // the largest of the kept elements, undefined when empty
+    const T &threshold() const { return heap.front(); }
+
+    // the kept elements in ascending order
+    std::vector<T> sorted() const {
+        std::vector<T> result = heap;
+        std::sort_heap(result.begin(), result.end(), comp);
+        return result;
+    }
+};
+
+// consecutive wins of one run that switch a merge from one comparison per element into galloping mode
+constexpr int TIM_SORT_MIN_GALLOP = 7;
+
+// first position in sorted [first, last) whose element is greater than value, probing 1, 2, 4, ... from the front
+template<typename RandomIt, typename T, typename Compare>
+RandomIt gallop_upper_bound(RandomIt first, RandomIt last, const T &value, Compare comp){
+    auto size = last - first;
+    decltype(size) bound = 1;
+    while (bound < size && !comp(value, first[bound])) bound *= 2;
+    return std::upper_bound(first + bound / 2, first + std::min(bound + 1, size), value, comp);
+}
+
+// first position in sorted [first, last) whose element is not less than value, probing 1, 2, 4, ... from the front
+template<typename RandomIt, typename T, typename Compare>
+RandomIt gallop_lower_bound(RandomIt first, RandomIt last, const T &value, Compare comp){
+    auto size = last - first;
+    decltype(size) bound = 1;
+    while (bound < size && comp(first[bound], value)) bound *= 2;
+    return std::lower_bound(first + bound / 2, first + std::min(bound + 1, size), value, comp);
+}
+
+// merge the buffered run [first1, last1) with the run [first2, last2) that sits right after target,
+// ties are taken from the buffered run; once one side wins TIM_SORT_MIN_GALLOP times in a row
+// the rest of its winning streak is found by galloping and moved as a block
+template<typename BufferIt, typename RandomIt, typename Compare>
+void gallop_merge(BufferIt first1, BufferIt last1, RandomIt first2, RandomIt last2, RandomIt target, Compare comp){
+    int wins1 = 0;
+    int wins2 = 0;
+    while (first1 != last1 && first2 != last2){
+        if (comp(*first2, *first1)){
+            *target++ = std::move(*first2++);
+            wins2++;
+            wins1 = 0;
+        }
+        else {
+            *target++ = std::move(*first1++);
+            wins1++;
+            wins2 = 0;
+        }
+        if (wins1 >= TIM_SORT_MIN_GALLOP && first2 != last2){
+            BufferIt end = gallop_upper_bound(first1, last1, *first2, comp);
+            target = std::move(first1, end, target);
+            first1 = end;
+            wins1 = 0;
+        }
+        else if (wins2 >= TIM_SORT_MIN_GALLOP && first1 != last1){
+            RandomIt end = gallop_lower_bound(first2, last2, *first1, comp);
+            target = std::move(first2, end, target);
+            first2 = end;
+            wins2 = 0;
+        }
+    }
+    // whatever is left of the second run is already in place
+    std::move(first1, last1, target);
+}
+
+// merge the adjacent sorted runs [first, mid) and [mid, last), the parts already in place are trimmed
+// by galloping and only the smaller of the remaining runs is moved to the buffer
+template<typename RandomIt, typename Compare>
+void tim_sort_merge(RandomIt first, RandomIt mid, RandomIt last, Compare comp,
+                    std::vector<typename std::iterator_traits<RandomIt>::value_type> &buffer){
+    first = gallop_upper_bound(first, mid, *mid, comp);
+    if (first == mid) return;
+    last = gallop_lower_bound(mid, last, *(mid - 1), comp);
+    if (last == mid) return;
+    size_t left_size = (size_t)(mid - first);
+    size_t right_size = (size_t)(last - mid);
+    if (buffer.size() < std::min(left_size, right_size)){
+        VE281P1_SORT_STATS_ALLOCATION(1);
+        buffer.resize(std::min(left_size, right_size));
+    }
+    if (left_size <= right_size){
+        std::move(first, mid, buffer.begin());
+        gallop_merge(buffer.begin(), buffer.begin() + left_size, mid, last, first, comp);
+    }
+    else {
+        // merge from the back: reversed runs under the reversed order
+        std::move(mid, last, buffer.begin());
+        typedef std::reverse_iterator<RandomIt> Reverse;
+        typedef std::reverse_iterator<typename std::vector<typename std::iterator_traits<RandomIt>::value_type>::iterator> ReverseBuffer;
+        gallop_merge(ReverseBuffer(buffer.begin() + right_size), ReverseBuffer(buffer.begin()),
+                     Reverse(mid), Reverse(first), Reverse(last),
+                     [&comp](const auto &a, const auto &b) { return comp(b, a); });
+    }
+}
+
+// length of the natural run starting at first, a strictly descending run is reversed in place
+template<typename RandomIt, typename Compare>
+typename std::iterator_traits<RandomIt>::difference_type make_ascending_run(RandomIt first, RandomIt last, Compare comp){
+    RandomIt end = first + 1;
+    if (end == last) return 1;
+    if (comp(*end, *first)){
+        while (end != last && comp(*end, *(end - 1))) ++end;
+        std::reverse(first, end);
+    }
+    else {
+        while (end != last && !comp(*end, *(end - 1))) ++end;
+    }
+    return end - first;
+}
+
+// adaptive stable sort: natural runs are extended to a minimum length with insertion sort and merged
+// under the usual run-stack invariants, nearly sorted input costs close to O(n)
+template<typename RandomIt, typename Compare = std::less<typename std::iterator_traits<RandomIt>::value_type>>
+void tim_sort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    typedef typename std::iterator_traits<RandomIt>::difference_type Index;
+    Index length = last - first;
+    if (length < 2) return;
+    Index min_run = length;
+    Index odd = 0;
+    while (min_run >= 64){
+        odd |= min_run & 1;
+        min_run >>= 1;
+    }
+    min_run += odd;
+    std::vector<typename std::iterator_traits<RandomIt>::value_type> buffer;
+    std::vector<std::pair<Index, Index>> runs; // (start, length)
+    auto merge_at = [&](size_t i){
+        RandomIt base = first + runs[i].first;
+        tim_sort_merge(base, base + runs[i].second, base + runs[i].second + runs[i + 1].second, comp, buffer);
+        runs[i].second += runs[i + 1].second;
+        runs.erase(runs.begin() + (Index)i + 1);
+    };
+    for (Index start = 0; start < length;){
+        Index run = make_ascending_run(first + start, last, comp);
+        if (run < min_run){
+            Index forced = std::min(min_run, length - start);
+            insertion_sort_range(first + start, first + start + forced, comp);
+            run = forced;
+        }
+        runs.emplace_back(start, run);
+        start += run;
+        while (runs.size() > 1){
+            size_t i = runs.size() - 2;
+            if ((i > 0 && runs[i - 1].second <= runs[i].second + runs[i + 1].second) ||
+                (i > 1 && runs[i - 2].second <= runs[i - 1].second + runs[i].second)){
+                if (runs[i - 1].second < runs[i + 1].second) i--;
+            }
+            else if (runs[i].second > runs[i + 1].second) break;
+            merge_at(i);
+        }
+    }
+    while (runs.size() > 1){
+        size_t i = runs.size() - 2;
+        if (i > 0 && runs[i - 1].second < runs[i + 1].second) i--;
+        merge_at(i);
+    }
+}
+
+template<typename T, typename Compare>
+void tim_sort(std::vector<T> &vector, Compare comp = std::less<T>()) {
+    tim_sort(vector.begin(), vector.end(), comp);
+}
+
+// LSD radix sort on an integral key, one stable counting pass per byte of the key,
+// passes in which every element falls into the same bucket are skipped
+template<typename RandomIt, typename KeyOf>
+void radix_sort_by_key(RandomIt first, RandomIt last, KeyOf key_of) {
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    typedef typename std::decay<decltype(key_of(*first))>::type Key;
+    static_assert(std::is_integral<Key>::value && !std::is_same<Key, bool>::value, "radix sort needs an integral key");
+    typedef typename std::make_unsigned<Key>::type Unsigned;
+    constexpr size_t passes = sizeof(Unsigned);
+    // flipping the sign bit makes signed keys order correctly as unsigned
+    const Unsigned flip = std::is_signed<Key>::value ? Unsigned(Unsigned(1) << (passes * CHAR_BIT - 1)) : Unsigned(0);
+    size_t length = (size_t)(last - first);
+    if (length < 2) return;
+    std::vector<size_t> count(passes * 256, 0);
+    for (RandomIt it = first; it != last; ++it){
+        Unsigned key = Unsigned(key_of(*it)) ^ flip;
+        for (size_t pass = 0; pass < passes; pass++) count[pass * 256 + ((key >> (pass * 8)) & 0xFF)]++;
+    }
+    std::vector<T> buffer;
+    bool in_buffer = false;
+    auto scatter = [&key_of, flip](auto source, auto source_end, auto target, size_t pass, size_t *bucket) {
+        for (; source != source_end; ++source){
+            Unsigned key = Unsigned(key_of(*source)) ^ flip;
+            target[bucket[(key >> (pass * 8)) & 0xFF]++] = std::move(*source);
+        }
+    };
+    for (size_t pass = 0; pass < passes; pass++){
+        size_t *bucket = count.data() + pass * 256;
+        const T &sample = in_buffer ? buffer[0] : *first;
+        if (bucket[(Unsigned(key_of(sample)) ^ flip) >> (pass * 8) & 0xFF] == length) continue;
+        if (buffer.empty()){
+            VE281P1_SORT_STATS_ALLOCATION(1);
+            buffer.resize(length);
+        }
+        size_t offset = 0;
+        for (size_t digit = 0; digit < 256; digit++){
+            size_t size = bucket[digit];
+            bucket[digit] = offset;
+            offset += size;
+        }
+        if (in_buffer) scatter(buffer.begin(), buffer.end(), first, pass, bucket);
+        else scatter(first, last, buffer.begin(), pass, bucket);
+        in_buffer = !in_buffer;
+    }
+    if (in_buffer) std::move(buffer.begin(), buffer.end(), first);
+}
+
+template<typename T, typename KeyOf>
+void radix_sort_by_key(std::vector<T> &vector, KeyOf key_of) {
+    radix_sort_by_key(vector.begin(), vector.end(), key_of);
+}
+
+// buckets this small are finished by insertion sort
+constexpr size_t MSD_RADIX_SORT_THRESHOLD = 32;
+
+// MSD radix sort of the strings in [first, last) that share their first depth characters,
+// buffer has room for last - first strings and bucket 0 holds the strings that end at depth
+template<typename RandomIt, typename BufferIt>
+void msd_radix_sort_helper(RandomIt first, RandomIt last, BufferIt buffer, size_t depth){
+    VE281P1_SORT_STATS_DEPTH();
+    size_t size = (size_t)(last - first);
+    if (size <= MSD_RADIX_SORT_THRESHOLD){
+        insertion_sort_range(first, last, std::less<std::string>());
+        return;
+    }
+    // digits 0 (string ended) to 256, counted two places up so the scatter below leaves the bucket starts
+    size_t count[259] = {};
+    for (RandomIt it = first; it != last; ++it){
+        size_t digit = depth < it->size() ? (unsigned char)(*it)[depth] + 1 : 0;
+        count[digit + 2]++;
+    }
+    for (size_t digit = 2; digit < 259; digit++) count[digit] += count[digit - 1];
+    for (RandomIt it = first; it != last; ++it){
+        size_t digit = depth < it->size() ? (unsigned char)(*it)[depth] + 1 : 0;
+        buffer[count[digit + 1]++] = std::move(*it);
+    }
+    std::move(buffer, buffer + size, first);
+    // count[digit] is now the start of bucket digit, count[digit + 1] its end
+    for (size_t digit = 1; digit < 257; digit++){
+        if (count[digit + 1] - count[digit] > 1)
+            msd_radix_sort_helper(first + count[digit], first + count[digit + 1], buffer + count[digit], depth + 1);
+    }
+}
+
+// LSD radix sort for integers, MSD radix sort for strings
+template<typename RandomIt>
+void radix_sort(RandomIt first, RandomIt last) {
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    if constexpr (std::is_same<T, std::string>::value){
+        std::vector<std::string> buffer((size_t)(last - first));
+        VE281P1_SORT_STATS_ALLOCATION(1);
+        msd_radix_sort_helper(first, last, buffer.begin(), 0);
+    }
+    else radix_sort_by_key(first, last, [](const T &item) { return item; });
+}
+
+template<typename T>
+void radix_sort(std::vector<T> &vector) {
+    radix_sort(vector.begin(), vector.end());
+}
+
+template<typename T, typename Compare>
+struct is_radix_sortable : std::integral_constant<bool,
+        ((std::is_integral<T>::value && !std::is_same<T, bool>::value) || std::is_same<T, std::string>::value) &&
+        (std::is_same<Compare, std::less<T>>::value || std::is_same<Compare, std::less<>>::value)> {};
+
+// radix sort when the order is the natural one on integers or strings, intro sort otherwise
+template<typename RandomIt, typename Compare = std::less<typename std::iterator_traits<RandomIt>::value_type>>
+void auto_sort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    if constexpr (is_radix_sortable<typename std::iterator_traits<RandomIt>::value_type, Compare>::value) radix_sort(first, last);
+    else intro_sort(first, last, comp);
+}
+
+template<typename T, typename Compare>
+void auto_sort(std::vector<T> &vector, Compare comp = std::less<T>()) {
+    auto_sort(vector.begin(), vector.end(), comp);
+}
+
+// indices that would sort [first, last): element first[order[0]] comes first and so on; stable,
+// only the compact index array is moved while sorting, the elements themselves are never touched
+template<typename RandomIt, typename Compare = std::less<typename std::iterator_traits<RandomIt>::value_type>>
+std::vector<size_t> argsort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    std::vector<size_t> order((size_t)(last - first));
+    VE281P1_SORT_STATS_ALLOCATION(1);
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    tim_sort(order.begin(), order.end(), [first, &comp](size_t a, size_t b) { return comp(first[a], first[b]); });
+    return order;
+}
+
+template<typename T, typename Compare>
+std::vector<size_t> argsort(const std::vector<T> &vector, Compare comp = std::less<T>()) {
+    return argsort(vector.begin(), vector.end(), comp);
+}
+
+// argsort on a key extracted once per element: the (key, index) pairs are sorted instead of going
+// back to the wide records on every comparison, integral keys under std::less are radix sorted
+template<typename RandomIt, typename KeyOf, typename Compare>
+std::vector<size_t> argsort_by_key(RandomIt first, RandomIt last, KeyOf key_of, Compare comp) {
+    typedef typename std::decay<decltype(key_of(*first))>::type Key;
+    std::vector<std::pair<Key, size_t>> keyed;
+    keyed.reserve((size_t)(last - first));
+    for (size_t i = 0; first + i != last; i++) keyed.emplace_back(key_of(first[i]), i);
+    if constexpr (std::is_integral<Key>::value && !std::is_same<Key, bool>::value && is_radix_sortable<Key, Compare>::value)
+        radix_sort_by_key(keyed.begin(), keyed.end(), [](const std::pair<Key, size_t> &item) { return item.first; });
+    else
+        tim_sort(keyed.begin(), keyed.end(), [&comp](const std::pair<Key, size_t> &a, const std::pair<Key, size_t> &b) {
+            return comp(a.first, b.first);
+        });
+    std::vector<size_t> order(keyed.size());
+    for (size_t i = 0; i < keyed.size(); i++) order[i] = keyed[i].second;
+    return order;
+}
+
+template<typename RandomIt, typename KeyOf>
+std::vector<size_t> argsort_by_key(RandomIt first, RandomIt last, KeyOf key_of) {
+    typedef typename std::decay<decltype(key_of(*first))>::type Key;
+    return argsort_by_key(first, last, key_of, std::less<Key>());
+}
+
+// rearrange the range starting at first so that its i-th element becomes the old first[order[i]],
+// following the cycles of the permutation so every element is moved once; order is consumed
+template<typename RandomIt>
+void apply_permutation(RandomIt first, std::vector<size_t> order) {
+    for (size_t i = 0; i < order.size(); i++) {
+        if (order[i] == i) continue;
+        auto temp = std::move(first[i]);
+        size_t j = i;
+        while (true) {
+            size_t next = order[j];
+            order[j] = j;
+            if (next == i) break;
+            first[j] = std::move(first[next]);
+            j = next;
+        }
+        first[j] = std::move(temp);
+    }
+}
+
+// structure-of-arrays sort: reorder the key column and every other column (given by its begin iterator,
+// each at least as long as the keys) by the order of the keys; stable
+template<typename KeyIt, typename Compare, typename... ColumnIts>
+void sort_columns(KeyIt key_first, KeyIt key_last, Compare comp, ColumnIts... columns) {
+    std::vector<size_t> order = argsort(key_first, key_last, comp);
+    (apply_permutation(columns, order), ...);
+    apply_permutation(key_first, std::move(order));
+}
+
+template<typename K, typename Compare, typename... Columns>
+void sort_columns(std::vector<K> &keys, Compare comp, std::vector<Columns> &... columns) {
+    // a fold, so sorting the keys alone (no columns) is fine too
+    if (((columns.size() != keys.size()) || ...))
+        throw std::invalid_argument("sort_columns: columns differ in length");
+    sort_columns(keys.begin(), keys.end(), comp, columns.begin()...);
+}
+
+#if __cplusplus >= 202002L
+// std::span views sort in place, e.g. over a memory-mapped file or part of an array
+template<typename T, size_t Extent, typename Compare = std::less<T>>
+void intro_sort(std::span<T, Extent> span, Compare comp = Compare()) {
+    intro_sort(span.begin(), span.end(), comp);
+}
+
+template<typename T, size_t Extent, typename Compare = std::less<T>>
+void parallel_quick_sort_inplace(std::span<T, Extent> span, Compare comp = Compare()) {
+    parallel_quick_sort_inplace(span.begin(), span.end(), comp);
+}
+
+template<typename T, size_t Extent, typename Compare = std::less<T>>
+void parallel_merge_sort(std::span<T, Extent> span, Compare comp = Compare()) {
+    parallel_merge_sort(span.begin(), span.end(), comp);
+}
+
+template<typename T, size_t Extent, typename Compare = std::less<T>>
+void sample_sort(std::span<T, Extent> span, Compare comp = Compare()) {
+    sample_sort(span.begin(), span.end(), comp);
+}
+
+template<typename T, size_t Extent, typename Compare = std::less<T>>
+void quick_sort_three_way(std::span<T, Extent> span, Compare comp = Compare()) {
+    quick_sort_three_way(span.begin(), span.end(), comp);
+}
+
+template<typename T, size_t Extent, typename Compare = std::less<T>>
+void tim_sort(std::span<T, Extent> span, Compare comp = Compare()) {
+    tim_sort(span.begin(), span.end(), comp);
+}
+
+template<typename T, size_t Extent, typename Compare = std::less<T>>
+void merge_sort_buffered(std::span<T, Extent> span, Compare comp = Compare()) {
+    merge_sort_buffered(span.begin(), span.end(), comp);
+}
+
+template<typename T, size_t Extent>
+void radix_sort(std::span<T, Extent> span) {
+    radix_sort(span.begin(), span.end());
+}
+
+template<typename T, size_t Extent, typename Compare = std::less<T>>
+void auto_sort(std::span<T, Extent> span, Compare comp = Compare()) {
+    auto_sort(span.begin(), span.end(), comp);
+}
+
+template<typename T, size_t Extent>
+void simd_sort(std::span<T, Extent> span) {
+    simd_sort(span.data(), span.data() + span.size());
 }
+#endif
 
 #endif //VE281P1_SORT_HPP
@@ -0,0 +1,195 @@
+// Regenerates the timing study of the p1 report for every sort in sort.hpp plus std::sort.
+//
+// usage: sort_benchmark [--format csv|json] [--output file] [--sizes 50,500,...] [--repeat r] [--seed s]
+//                       [--quadratic-limit n]
+//
+// For every algorithm, input distribution and size it records the best wall time of r runs on int,
+// and, from one extra run on an instrumented element type, the comparisons, copies/moves and heap allocations,
+// the deepest recursion and the number of badly unbalanced partitions (see sort_stats.hpp).
+// Quadratic sorts are skipped above --quadratic-limit elements (the report's "NA"), and so are the
+// first-element-pivot quick sorts on every distribution but random.
+//
+// The instrumented runs live in sort_benchmark_counted.cpp, the only unit built with VE281P1_SORT_STATS,
+// so the timed sorts here carry no hooks:
+//     g++ -std=c++17 -O2 -pthread sort_benchmark.cpp sort_benchmark_counted.cpp -o sort_benchmark
+
+#include "sort.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+static std::atomic<long long> allocation_count{0};
+
+// kept out of line so the compiler does not pair the inlined malloc/free against new/delete
+__attribute__((noinline)) void *operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void *p) noexcept { std::free(p); }
+
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+// sorts a copy of input on the instrumented element type and returns its counters,
+// false when the sort does not compare (radix, simd); see sort_benchmark_counted.cpp
+bool count_sort(const char *name, const std::vector<int> &input, sort_stats_snapshot &snapshot);
+
+struct algorithm {
+    const char *name;
+    bool quadratic;
+    bool first_pivot; // quadratic on presorted and few-unique inputs
+    void (*run)(std::vector<int> &);
+};
+
+static const algorithm algorithms[] = {
+        {"bubble",             true,  false, [](std::vector<int> &v) { bubble_sort(v, std::less<int>()); }},
+        {"insertion",          true,  false, [](std::vector<int> &v) { insertion_sort(v, std::less<int>()); }},
+        {"selection",          true,  false, [](std::vector<int> &v) { selection_sort(v, std::less<int>()); }},
+        {"merge",              false, false, [](std::vector<int> &v) { merge_sort(v, std::less<int>()); }},
+        {"merge_buffered",     false, false, [](std::vector<int> &v) { merge_sort_buffered(v, std::less<int>()); }},
+        {"tim",                false, false, [](std::vector<int> &v) { tim_sort(v, std::less<int>()); }},
+        {"quick_extra",        false, true,  [](std::vector<int> &v) { quick_sort_extra(v, std::less<int>()); }},
+        {"quick_three_way",    false, false, [](std::vector<int> &v) { quick_sort_three_way(v, std::less<int>()); }},
+        {"quick_inplace",      false, true,  [](std::vector<int> &v) { quick_sort_inplace(v, std::less<int>()); }},
+        {"intro",              false, false, [](std::vector<int> &v) { intro_sort(v, std::less<int>()); }},
+        {"parallel_quick",     false, false, [](std::vector<int> &v) { parallel_quick_sort_inplace(v, std::less<int>()); }},
+        {"parallel_merge",     false, false, [](std::vector<int> &v) { parallel_merge_sort(v, std::less<int>()); }},
+        {"sample",             false, false, [](std::vector<int> &v) { sample_sort(v, std::less<int>()); }},
+        {"radix",              false, false, [](std::vector<int> &v) { radix_sort(v); }},
+        {"simd",               false, false, [](std::vector<int> &v) { simd_sort(v); }},
+        {"std_sort",           false, false, [](std::vector<int> &v) { std::sort(v.begin(), v.end()); }},
+};
+
+static const char *const distributions[] = {"random", "sorted", "reverse", "few_unique", "organ_pipe"};
+
+std::vector<int> make_input(const std::string &distribution, int size, std::mt19937 &generator) {
+    std::vector<int> input(size);
+    for (int i = 0; i < size; i++) {
+        if (distribution == "random") input[i] = (int)generator();
+        else if (distribution == "sorted") input[i] = i;
+        else if (distribution == "reverse") input[i] = size - i;
+        else if (distribution == "few_unique") input[i] = (int)(generator() % 10);
+        else input[i] = i < size / 2 ? i : size - i; // organ pipe
+    }
+    return input;
+}
+
+struct result {
+    std::string algorithm;
+    std::string distribution;
+    int size;
+    double seconds;
+    long long comparisons; // -1 when not applicable
+    long long moves;
+    long long allocations;
+    long long max_depth; // -1 when not applicable
+    long long unbalanced_partitions;
+};
+
+std::vector<int> parse_sizes(const char *text) {
+    std::vector<int> sizes;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) sizes.push_back(std::atoi(item.c_str()));
+    return sizes;
+}
+
+void write_csv(std::ostream &out, const std::vector<result> &results) {
+    out << "algorithm,distribution,size,seconds,comparisons,moves,allocations,max_depth,unbalanced_partitions\n";
+    for (auto &r: results) {
+        out << r.algorithm << "," << r.distribution << "," << r.size << "," << r.seconds << ","
+            << r.comparisons << "," << r.moves << "," << r.allocations << "," << r.max_depth << ","
+            << r.unbalanced_partitions << "\n";
+    }
+}
+
+void write_json(std::ostream &out, const std::vector<result> &results) {
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        auto &r = results[i];
+        out << "  {\"algorithm\": \"" << r.algorithm << "\", \"distribution\": \"" << r.distribution
+            << "\", \"size\": " << r.size << ", \"seconds\": " << r.seconds
+            << ", \"comparisons\": " << r.comparisons << ", \"moves\": " << r.moves
+            << ", \"allocations\": " << r.allocations << ", \"max_depth\": " << r.max_depth
+            << ", \"unbalanced_partitions\": " << r.unbalanced_partitions << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+}
+
+int main(int argc, char *argv[]) {
+    std::string format = "csv";
+    std::string output;
+    std::vector<int> sizes = {50, 500, 5000, 20000, 50000, 200000};
+    int repeat = 3;
+    int quadratic_limit = 50000;
+    unsigned seed = 281;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!std::strcmp(argv[i], "--format")) format = argv[i + 1];
+        else if (!std::strcmp(argv[i], "--output")) output = argv[i + 1];
+        else if (!std::strcmp(argv[i], "--sizes")) sizes = parse_sizes(argv[i + 1]);
+        else if (!std::strcmp(argv[i], "--repeat")) repeat = std::max(1, std::atoi(argv[i + 1]));
+        else if (!std::strcmp(argv[i], "--seed")) seed = (unsigned)std::atoi(argv[i + 1]);
+        else if (!std::strcmp(argv[i], "--quadratic-limit")) quadratic_limit = std::atoi(argv[i + 1]);
+        else {
+            std::cerr << "unknown option " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    if (format != "csv" && format != "json") {
+        std::cerr << "unknown format " << format << std::endl;
+        return 1;
+    }
+    std::vector<result> results;
+    for (const char *distribution: distributions) {
+        for (int size: sizes) {
+            std::mt19937 generator(seed);
+            std::vector<int> input = make_input(distribution, size, generator);
+            std::vector<int> expected = input;
+            std::sort(expected.begin(), expected.end());
+            for (auto &algo: algorithms) {
+                if (algo.quadratic && size > quadratic_limit) continue;
+                if (algo.first_pivot && size > quadratic_limit && std::strcmp(distribution, "random") != 0) continue;
+                result r = {algo.name, distribution, size, 0, -1, -1, 0, -1, -1};
+                for (int k = 0; k < repeat; k++) {
+                    std::vector<int> data = input;
+                    long long allocations = allocation_count.load();
+                    auto start = std::chrono::steady_clock::now();
+                    algo.run(data);
+                    auto stop = std::chrono::steady_clock::now();
+                    allocations = allocation_count.load() - allocations;
+                    double seconds = std::chrono::duration<double>(stop - start).count();
+                    if (k == 0 || seconds < r.seconds) r.seconds = seconds;
+                    r.allocations = allocations;
+                    if (data != expected) {
+                        std::cerr << algo.name << " failed on " << distribution << " " << size << std::endl;
+                        return 1;
+                    }
+                }
+                sort_stats_snapshot snapshot;
+                if (count_sort(algo.name, input, snapshot)) {
+                    r.comparisons = (long long)snapshot.comparisons;
+                    r.moves = (long long)snapshot.moves;
+                    r.max_depth = (long long)snapshot.max_depth;
+                    r.unbalanced_partitions = (long long)snapshot.unbalanced_partitions;
+                }
+                results.push_back(r);
+            }
+        }
+    }
+    std::ofstream file;
+    if (!output.empty()) file.open(output);
+    std::ostream &out = output.empty() ? std::cout : file;
+    if (format == "json") write_json(out, results);
+    else write_csv(out, results);
+    return 0;
+}
@@ -0,0 +1,57 @@
+// The instrumented runs of sort_benchmark.
+//
+// VE281P1_SORT_STATS is defined for this translation unit only, so the recursion, partition and buffer hooks
+// of sort.hpp never run in the timed sorts of sort_benchmark.cpp. The sorts here are all instantiated on
+// counted_value, never on the plain int the timed runs use, so the two units share no instrumented code.
+
+#define VE281P1_SORT_STATS
+#include "sort.hpp"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// comparisons, moves, recursion depth and partition balance of the instrumented run
+static sort_stats counters;
+
+typedef counted_value<int> counted;
+
+static counting_compare<std::less<counted>> counting_less() {
+    return count_comparisons(std::less<counted>(), counters);
+}
+
+struct counted_algorithm {
+    const char *name;
+    void (*run)(std::vector<counted> &);
+};
+
+static const counted_algorithm counted_algorithms[] = {
+        {"bubble",             [](std::vector<counted> &v) { bubble_sort(v, counting_less()); }},
+        {"insertion",          [](std::vector<counted> &v) { insertion_sort(v, counting_less()); }},
+        {"selection",          [](std::vector<counted> &v) { selection_sort(v, counting_less()); }},
+        {"merge",              [](std::vector<counted> &v) { merge_sort(v, counting_less()); }},
+        {"merge_buffered",     [](std::vector<counted> &v) { merge_sort_buffered(v, counting_less()); }},
+        {"tim",                [](std::vector<counted> &v) { tim_sort(v, counting_less()); }},
+        {"quick_extra",        [](std::vector<counted> &v) { quick_sort_extra(v, counting_less()); }},
+        {"quick_three_way",    [](std::vector<counted> &v) { quick_sort_three_way(v, counting_less()); }},
+        {"quick_inplace",      [](std::vector<counted> &v) { quick_sort_inplace(v, counting_less()); }},
+        {"intro",              [](std::vector<counted> &v) { intro_sort(v, counting_less()); }},
+        {"parallel_quick",     [](std::vector<counted> &v) { parallel_quick_sort_inplace(v, counting_less()); }},
+        {"parallel_merge",     [](std::vector<counted> &v) { parallel_merge_sort(v, counting_less()); }},
+        {"sample",             [](std::vector<counted> &v) { sample_sort(v, counting_less()); }},
+        {"std_sort",           [](std::vector<counted> &v) { std::sort(v.begin(), v.end(), counting_less()); }},
+};
+
+bool count_sort(const char *name, const std::vector<int> &input, sort_stats_snapshot &snapshot) {
+    for (auto &algo: counted_algorithms) {
+        if (std::strcmp(algo.name, name) != 0) continue;
+        std::vector<counted> data(input.begin(), input.end());
+        counters.reset();
+        {
+            sort_stats_scope scope(counters);
+            algo.run(data);
+        }
+        snapshot = counters.snapshot();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,401 @@
+#ifndef VE281P1_SORT_SIMD_HPP
+#define VE281P1_SORT_SIMD_HPP
+
+#include <vector>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define VE281P1_SORT_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// partitions of at most this many elements are finished by a sorting network
+constexpr size_t SIMD_NETWORK_SIZE = 16;
+
+// the kernels only know the natural order of these types, NaNs are not ordered
+template<typename T>
+struct is_simd_sortable : std::integral_constant<bool,
+        std::is_same<T, int32_t>::value || std::is_same<T, float>::value || std::is_same<T, double>::value> {};
+
+enum class simd_level { scalar, sse4, avx2 };
+
+// checked once at runtime, so the header runs on any x86 (or non-x86) CPU without -mavx2
+inline simd_level detect_simd_level() {
+#ifdef VE281P1_SORT_SIMD_X86
+    static const simd_level level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return simd_level::avx2;
+        if (__builtin_cpu_supports("sse4.1")) return simd_level::sse4;
+        return simd_level::scalar;
+    }();
+    return level;
+#else
+    return simd_level::scalar;
+#endif
+}
+
+#ifdef VE281P1_SORT_SIMD_X86
+
+#define VE281P1_AVX2 __attribute__((target("avx2")))
+#define VE281P1_SSE4 __attribute__((target("sse4.1")))
+
+// Every ops struct exposes the same register interface to the kernels below.
+// permute and blend work on "units" (32-bit for AVX2, bytes for SSE) so one
+// index/mask table serves 32- and 64-bit lanes alike.
+template<typename T>
+struct avx2_ops;
+
+template<>
+struct avx2_ops<int32_t> {
+    typedef int32_t value;
+    typedef __m256i reg;
+    typedef int32_t unit;
+    static constexpr int lanes = 8;
+    VE281P1_AVX2 static reg load(const value *p) { return _mm256_loadu_si256((const __m256i *)p); }
+    VE281P1_AVX2 static void store(value *p, reg v) { _mm256_storeu_si256((__m256i *)p, v); }
+    VE281P1_AVX2 static reg broadcast(value x) { return _mm256_set1_epi32(x); }
+    VE281P1_AVX2 static reg min(reg a, reg b) { return _mm256_min_epi32(a, b); }
+    VE281P1_AVX2 static reg max(reg a, reg b) { return _mm256_max_epi32(a, b); }
+    VE281P1_AVX2 static reg permute(reg v, const unit *index) {
+        return _mm256_permutevar8x32_epi32(v, _mm256_loadu_si256((const __m256i *)index));
+    }
+    VE281P1_AVX2 static reg blend(reg a, reg b, const unit *mask) {
+        return _mm256_blendv_epi8(a, b, _mm256_loadu_si256((const __m256i *)mask));
+    }
+    VE281P1_AVX2 static unsigned less_mask(reg v, reg pivot) {
+        return (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(pivot, v)));
+    }
+};
+
+template<>
+struct avx2_ops<float> {
+    typedef float value;
+    typedef __m256 reg;
+    typedef int32_t unit;
+    static constexpr int lanes = 8;
+    VE281P1_AVX2 static reg load(const value *p) { return _mm256_loadu_ps(p); }
+    VE281P1_AVX2 static void store(value *p, reg v) { _mm256_storeu_ps(p, v); }
+    VE281P1_AVX2 static reg broadcast(value x) { return _mm256_set1_ps(x); }
+    VE281P1_AVX2 static reg min(reg a, reg b) { return _mm256_min_ps(a, b); }
+    VE281P1_AVX2 static reg max(reg a, reg b) { return _mm256_max_ps(a, b); }
+    VE281P1_AVX2 static reg permute(reg v, const unit *index) {
+        return _mm256_permutevar8x32_ps(v, _mm256_loadu_si256((const __m256i *)index));
+    }
+    VE281P1_AVX2 static reg blend(reg a, reg b, const unit *mask) {
+        return _mm256_blendv_ps(a, b, _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i *)mask)));
+    }
+    VE281P1_AVX2 static unsigned less_mask(reg v, reg pivot) {
+        return (unsigned)_mm256_movemask_ps(_mm256_cmp_ps(v, pivot, _CMP_LT_OQ));
+    }
+};
+
+template<>
+struct avx2_ops<double> {
+    typedef double value;
+    typedef __m256d reg;
+    typedef int32_t unit;
+    static constexpr int lanes = 4;
+    VE281P1_AVX2 static reg load(const value *p) { return _mm256_loadu_pd(p); }
+    VE281P1_AVX2 static void store(value *p, reg v) { _mm256_storeu_pd(p, v); }
+    VE281P1_AVX2 static reg broadcast(value x) { return _mm256_set1_pd(x); }
+    VE281P1_AVX2 static reg min(reg a, reg b) { return _mm256_min_pd(a, b); }
+    VE281P1_AVX2 static reg max(reg a, reg b) { return _mm256_max_pd(a, b); }
+    VE281P1_AVX2 static reg permute(reg v, const unit *index) {
+        return _mm256_castps_pd(_mm256_permutevar8x32_ps(_mm256_castpd_ps(v), _mm256_loadu_si256((const __m256i *)index)));
+    }
+    VE281P1_AVX2 static reg blend(reg a, reg b, const unit *mask) {
+        return _mm256_blendv_pd(a, b, _mm256_castsi256_pd(_mm256_loadu_si256((const __m256i *)mask)));
+    }
+    VE281P1_AVX2 static unsigned less_mask(reg v, reg pivot) {
+        return (unsigned)_mm256_movemask_pd(_mm256_cmp_pd(v, pivot, _CMP_LT_OQ));
+    }
+};
+
+template<typename T>
+struct sse4_ops;
+
+template<>
+struct sse4_ops<int32_t> {
+    typedef int32_t value;
+    typedef __m128i reg;
+    typedef int8_t unit;
+    static constexpr int lanes = 4;
+    VE281P1_SSE4 static reg load(const value *p) { return _mm_loadu_si128((const __m128i *)p); }
+    VE281P1_SSE4 static void store(value *p, reg v) { _mm_storeu_si128((__m128i *)p, v); }
+    VE281P1_SSE4 static reg broadcast(value x) { return _mm_set1_epi32(x); }
+    VE281P1_SSE4 static reg min(reg a, reg b) { return _mm_min_epi32(a, b); }
+    VE281P1_SSE4 static reg max(reg a, reg b) { return _mm_max_epi32(a, b); }
+    VE281P1_SSE4 static reg permute(reg v, const unit *index) {
+        return _mm_shuffle_epi8(v, _mm_loadu_si128((const __m128i *)index));
+    }
+    VE281P1_SSE4 static reg blend(reg a, reg b, const unit *mask) {
+        return _mm_blendv_epi8(a, b, _mm_loadu_si128((const __m128i *)mask));
+    }
+    VE281P1_SSE4 static unsigned less_mask(reg v, reg pivot) {
+        return (unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(pivot, v)));
+    }
+};
+
+template<>
+struct sse4_ops<float> {
+    typedef float value;
+    typedef __m128 reg;
+    typedef int8_t unit;
+    static constexpr int lanes = 4;
+    VE281P1_SSE4 static reg load(const value *p) { return _mm_loadu_ps(p); }
+    VE281P1_SSE4 static void store(value *p, reg v) { _mm_storeu_ps(p, v); }
+    VE281P1_SSE4 static reg broadcast(value x) { return _mm_set1_ps(x); }
+    VE281P1_SSE4 static reg min(reg a, reg b) { return _mm_min_ps(a, b); }
+    VE281P1_SSE4 static reg max(reg a, reg b) { return _mm_max_ps(a, b); }
+    VE281P1_SSE4 static reg permute(reg v, const unit *index) {
+        return _mm_castsi128_ps(_mm_shuffle_epi8(_mm_castps_si128(v), _mm_loadu_si128((const __m128i *)index)));
+    }
+    VE281P1_SSE4 static reg blend(reg a, reg b, const unit *mask) {
+        return _mm_blendv_ps(a, b, _mm_castsi128_ps(_mm_loadu_si128((const __m128i *)mask)));
+    }
+    VE281P1_SSE4 static unsigned less_mask(reg v, reg pivot) {
+        return (unsigned)_mm_movemask_ps(_mm_cmplt_ps(v, pivot));
+    }
+};
+
+template<>
+struct sse4_ops<double> {
+    typedef double value;
+    typedef __m128d reg;
+    typedef int8_t unit;
+    static constexpr int lanes = 2;
+    VE281P1_SSE4 static reg load(const value *p) { return _mm_loadu_pd(p); }
+    VE281P1_SSE4 static void store(value *p, reg v) { _mm_storeu_pd(p, v); }
+    VE281P1_SSE4 static reg broadcast(value x) { return _mm_set1_pd(x); }
+    VE281P1_SSE4 static reg min(reg a, reg b) { return _mm_min_pd(a, b); }
+    VE281P1_SSE4 static reg max(reg a, reg b) { return _mm_max_pd(a, b); }
+    VE281P1_SSE4 static reg permute(reg v, const unit *index) {
+        return _mm_castsi128_pd(_mm_shuffle_epi8(_mm_castpd_si128(v), _mm_loadu_si128((const __m128i *)index)));
+    }
+    VE281P1_SSE4 static reg blend(reg a, reg b, const unit *mask) {
+        return _mm_blendv_pd(a, b, _mm_castsi128_pd(_mm_loadu_si128((const __m128i *)mask)));
+    }
+    VE281P1_SSE4 static unsigned less_mask(reg v, reg pivot) {
+        return (unsigned)_mm_movemask_pd(_mm_cmplt_pd(v, pivot));
+    }
+};
+
+// The kernels are stamped out once per instruction set, a template cannot carry a per-instantiation target.
+//
+// bitonic_sort_network: sorts exactly SIMD_NETWORK_SIZE values held in SIMD_NETWORK_SIZE / lanes registers,
+// exchanges between lanes closer than a register go through permute + min/max + blend,
+// exchanges across registers are plain min/max.
+//
+// block_partition: in-place partition of data[0, n) around pivot, returns the number of elements less than it.
+// The classification of each block is done lanes at a time with a vector compare and a movemask,
+// the misplaced elements of a left and a right block are then swapped pairwise (BlockQuicksort style).
+#define VE281P1_DEFINE_SIMD_KERNELS(SUFFIX, TARGET)                                                      \
+template<typename Ops>                                                                                   \
+TARGET void bitonic_sort_network_##SUFFIX(typename Ops::value *data) {                                   \
+    typedef typename Ops::reg reg;                                                                       \
+    typedef typename Ops::unit unit;                                                                     \
+    constexpr int lanes = Ops::lanes;                                                                    \
+    constexpr int regs = (int)SIMD_NETWORK_SIZE / lanes;                                                 \
+    constexpr int units = (int)(sizeof(typename Ops::value) / sizeof(unit));                             \
+    reg v[regs];                                                                                         \
+    for (int r = 0; r < regs; r++) v[r] = Ops::load(data + r * lanes);                                   \
+    for (int k = 2; k <= (int)SIMD_NETWORK_SIZE; k *= 2){                                                \
+        for (int j = k / 2; j > 0; j /= 2){                                                              \
+            if (j >= lanes){                                                                             \
+                for (int r = 0; r < regs; r++){                                                          \
+                    int partner = r ^ (j / lanes);                                                       \
+                    if (partner < r) continue;                                                           \
+                    reg low = Ops::min(v[r], v[partner]);                                                \
+                    reg high = Ops::max(v[r], v[partner]);                                               \
+                    bool ascending = ((r * lanes) & k) == 0;                                             \
+                    v[r] = ascending ? low : high;                                                       \
+                    v[partner] = ascending ? high : low;                                                 \
+                }                                                                                        \
+                continue;                                                                                \
+            }                                                                                            \
+            unit index[lanes * units];                                                                   \
+            for (int i = 0; i < lanes; i++)                                                              \
+                for (int b = 0; b < units; b++) index[i * units + b] = (unit)((i ^ j) * units + b);      \
+            for (int r = 0; r < regs; r++){                                                              \
+                unit mask[lanes * units];                                                                \
+                for (int i = 0; i < lanes; i++){                                                         \
+                    bool take_high = ((i & j) == 0) != (((r * lanes + i) & k) == 0);                     \
+                    for (int b = 0; b < units; b++) mask[i * units + b] = take_high ? (unit)-1 : (unit)0;\
+                }                                                                                        \
+                reg partner = Ops::permute(v[r], index);                                                 \
+                v[r] = Ops::blend(Ops::min(v[r], partner), Ops::max(v[r], partner), mask);               \
+            }                                                                                            \
+        }                                                                                                \
+    }                                                                                                    \
+    for (int r = 0; r < regs; r++) Ops::store(data + r * lanes, v[r]);                                   \
+}                                                                                                        \
+                                                                                                         \
+template<typename Ops>                                                                                   \
+TARGET size_t block_partition_##SUFFIX(typename Ops::value *data, size_t n, typename Ops::value pivot) {  \
+    constexpr size_t block = 64;                                                                         \
+    constexpr size_t lanes = Ops::lanes;                                                                 \
+    constexpr unsigned lane_bits = (1u << lanes) - 1;                                                    \
+    unsigned char offsets_left[block];                                                                   \
+    unsigned char offsets_right[block];                                                                  \
+    size_t left = 0, right = n; /* [0, left) < pivot, [right, n) >= pivot */                             \
+    size_t count_left = 0, count_right = 0, start_left = 0, start_right = 0;                             \
+    typename Ops::reg splitter = Ops::broadcast(pivot);                                                  \
+    while (right - left >= 2 * block){                                                                   \
+        if (count_left == 0){                                                                            \
+            start_left = 0;                                                                              \
+            for (size_t i = 0; i < block; i += lanes){                                                   \
+                unsigned bits = ~Ops::less_mask(Ops::load(data + left + i), splitter) & lane_bits;       \
+                for (; bits; bits &= bits - 1) offsets_left[count_left++] = (unsigned char)(i + __builtin_ctz(bits)); \
+            }                                                                                            \
+        }                                                                                                \
+        if (count_right == 0){                                                                           \
+            start_right = 0;                                                                             \
+            for (size_t i = 0; i < block; i += lanes){                                                   \
+                unsigned bits = Ops::less_mask(Ops::load(data + right - block + i), splitter);           \
+                for (; bits; bits &= bits - 1)                                                           \
+                    offsets_right[count_right++] = (unsigned char)(block - 1 - i - __builtin_ctz(bits)); \
+            }                                                                                            \
+        }                                                                                                \
+        size_t count = std::min(count_left, count_right);                                                \
+        for (size_t k = 0; k < count; k++)                                                               \
+            std::swap(data[left + offsets_left[start_left + k]], data[right - 1 - offsets_right[start_right + k]]); \
+        count_left -= count;                                                                             \
+        count_right -= count;                                                                            \
+        start_left += count;                                                                             \
+        start_right += count;                                                                            \
+        if (count_left == 0) left += block;                                                              \
+        if (count_right == 0) right -= block;                                                            \
+    }                                                                                                    \
+    /* everything outside [left, right) is in place, finish the rest with a scalar Hoare scan */         \
+    while (true){                                                                                        \
+        while (left < right && data[left] < pivot) left++;                                               \
+        while (left < right && !(data[right - 1] < pivot)) right--;                                      \
+        if (left >= right) break;                                                                        \
+        std::swap(data[left], data[right - 1]);                                                          \
+        left++;                                                                                          \
+        right--;                                                                                         \
+    }                                                                                                    \
+    return left;                                                                                         \
+}
+
+VE281P1_DEFINE_SIMD_KERNELS(avx2, VE281P1_AVX2)
+VE281P1_DEFINE_SIMD_KERNELS(sse4, VE281P1_SSE4)
+
+#undef VE281P1_DEFINE_SIMD_KERNELS
+
+#endif //VE281P1_SORT_SIMD_X86
+
+// scalar fallback, also used for the partitions of simd_quick_sort on CPUs without SSE4.1
+template<typename T>
+size_t scalar_partition(T *data, size_t n, T pivot) {
+    size_t left = 0, right = n;
+    while (true){
+        while (left < right && data[left] < pivot) left++;
+        while (left < right && !(data[right - 1] < pivot)) right--;
+        if (left >= right) break;
+        std::swap(data[left], data[right - 1]);
+        left++;
+        right--;
+    }
+    return left;
+}
+
+// sort data[0, n) for n <= SIMD_NETWORK_SIZE
+template<typename T>
+void simd_sort_small(T *data, size_t n) {
+    static_assert(is_simd_sortable<T>::value, "no sorting network for this type");
+    if (n < 2) return;
+#ifdef VE281P1_SORT_SIMD_X86
+    simd_level level = detect_simd_level();
+    if (level != simd_level::scalar){
+        // pad with the largest value so the padding sorts to the back
+        T padded[SIMD_NETWORK_SIZE];
+        const T filler = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                              : std::numeric_limits<T>::max();
+        std::copy(data, data + n, padded);
+        std::fill(padded + n, padded + SIMD_NETWORK_SIZE, filler);
+        if (level == simd_level::avx2) bitonic_sort_network_avx2<avx2_ops<T>>(padded);
+        else bitonic_sort_network_sse4<sse4_ops<T>>(padded);
+        std::copy(padded, padded + n, data);
+        return;
+    }
+#endif
+    for (size_t i = 1; i < n; i++){
+        T temp = data[i];
+        size_t j = i;
+        for (; j > 0 && temp < data[j - 1]; j--) data[j] = data[j - 1];
+        data[j] = temp;
+    }
+}
+
+// partition data[0, n) around pivot, returns the number of elements less than pivot
+template<typename T>
+size_t simd_partition(T *data, size_t n, T pivot) {
+    static_assert(is_simd_sortable<T>::value, "no vectorized partition for this type");
+#ifdef VE281P1_SORT_SIMD_X86
+    switch (detect_simd_level()){
+        case simd_level::avx2:
+            return block_partition_avx2<avx2_ops<T>>(data, n, pivot);
+        case simd_level::sse4:
+            return block_partition_sse4<sse4_ops<T>>(data, n, pivot);
+        default:
+            break;
+    }
+#endif
+    return scalar_partition(data, n, pivot);
+}
+
+// quick sort on the vectorized partition with sorting-network leaves,
+// falls back to heap sort when the recursion gets too deep
+template<typename T>
+void simd_quick_sort(T *data, size_t n, int depth_limit) {
+    while (n > SIMD_NETWORK_SIZE){
+        if (depth_limit-- == 0){
+            std::make_heap(data, data + n);
+            std::sort_heap(data, data + n);
+            return;
+        }
+        T a = data[0], b = data[n / 2], c = data[n - 1];
+        T pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+        size_t middle = simd_partition(data, n, pivot);
+        if (middle == 0){
+            // pivot is the minimum, everything not greater than it is equal to it and already in place once moved forward
+            size_t equal = 0;
+            for (size_t k = 0; k < n; k++){
+                if (!(pivot < data[k])) std::swap(data[equal++], data[k]);
+            }
+            data += equal;
+            n -= equal;
+            continue;
+        }
+        if (middle < n - middle){
+            simd_quick_sort(data, middle, depth_limit);
+            data += middle;
+            n -= middle;
+        }
+        else {
+            simd_quick_sort(data + middle, n - middle, depth_limit);
+            n = middle;
+        }
+    }
+    simd_sort_small(data, n);
+}
+
+template<typename T>
+void simd_sort(T *first, T *last) {
+    int depth_limit = 0;
+    for (size_t n = (size_t)(last - first); n > 1; n >>= 1) depth_limit += 2;
+    simd_quick_sort(first, (size_t)(last - first), depth_limit);
+}
+
+template<typename T>
+void simd_sort(std::vector<T> &vector) {
+    simd_sort(vector.data(), vector.data() + vector.size());
+}
+
+#endif //VE281P1_SORT_SIMD_HPP
@@ -0,0 +1,188 @@
+#ifndef VE281P1_SORT_STATS_HPP
+#define VE281P1_SORT_STATS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+/**
+ * Opt-in instrumentation for the sorts in sort.hpp.
+ *
+ * - comparisons: wrap the comparator with count_comparisons(comp, stats)
+ * - moves: sort counted_value<T> instead of T, every copy and move of an element is counted
+ * - recursion depth, partitions (and how many of them were badly unbalanced) and temporary buffers:
+ *   reported by hooks inside the sort helpers. The hooks only exist when VE281P1_SORT_STATS is defined
+ *   before sort.hpp is included, otherwise they expand to nothing.
+ *
+ * Everything is reported to the sort_stats made active with a sort_stats_scope. The counters are atomic,
+ * so the parallel sorts may report from the pool threads.
+ */
+
+// plain copy of the counters at one point in time
+struct sort_stats_snapshot {
+    uint64_t comparisons;
+    uint64_t moves;
+    uint64_t allocations;
+    uint64_t partitions;
+    uint64_t unbalanced_partitions; // the larger side kept more than 15/16 of the range
+    uint64_t max_depth;
+};
+
+class sort_stats {
+    std::atomic<uint64_t> comparisons{0};
+    std::atomic<uint64_t> moves{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> partitions{0};
+    std::atomic<uint64_t> unbalanced_partitions{0};
+    std::atomic<uint64_t> max_depth{0};
+
+public:
+    void add_comparisons(uint64_t count) { comparisons.fetch_add(count, std::memory_order_relaxed); }
+
+    void add_moves(uint64_t count) { moves.fetch_add(count, std::memory_order_relaxed); }
+
+    void add_allocations(uint64_t count) { allocations.fetch_add(count, std::memory_order_relaxed); }
+
+    void record_partition(size_t left, size_t right) {
+        partitions.fetch_add(1, std::memory_order_relaxed);
+        size_t total = left + right;
+        if (total > 16 && std::max(left, right) * 16 > total * 15)
+            unbalanced_partitions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void record_depth(uint64_t depth) {
+        uint64_t deepest = max_depth.load(std::memory_order_relaxed);
+        while (depth > deepest && !max_depth.compare_exchange_weak(deepest, depth, std::memory_order_relaxed)) {}
+    }
+
+    void reset() {
+        comparisons = 0;
+        moves = 0;
+        allocations = 0;
+        partitions = 0;
+        unbalanced_partitions = 0;
+        max_depth = 0;
+    }
+
+    sort_stats_snapshot snapshot() const {
+        return {comparisons.load(), moves.load(), allocations.load(), partitions.load(), unbalanced_partitions.load(),
+                max_depth.load()};
+    }
+
+    // the stats the hooks and counted_value report to, nullptr when nothing is being measured
+    static std::atomic<sort_stats *> &active() {
+        static std::atomic<sort_stats *> current{nullptr};
+        return current;
+    }
+};
+
+// makes stats the active one for its lifetime
+class sort_stats_scope {
+    sort_stats *previous;
+
+public:
+    explicit sort_stats_scope(sort_stats &stats) : previous(sort_stats::active().exchange(&stats)) {}
+
+    sort_stats_scope(const sort_stats_scope &) = delete;
+
+    sort_stats_scope &operator=(const sort_stats_scope &) = delete;
+
+    ~sort_stats_scope() { sort_stats::active().store(previous); }
+};
+
+template<typename Compare>
+struct counting_compare {
+    Compare comp;
+    sort_stats *stats;
+
+    template<typename A, typename B>
+    bool operator()(const A &a, const B &b) const {
+        stats->add_comparisons(1);
+        return comp(a, b);
+    }
+};
+
+template<typename Compare>
+counting_compare<Compare> count_comparisons(Compare comp, sort_stats &stats) {
+    return counting_compare<Compare>{comp, &stats};
+}
+
+// a T that reports every copy and move of itself to the active stats
+template<typename T>
+class counted_value {
+    T value;
+
+    static void count() {
+        if (sort_stats *stats = sort_stats::active().load(std::memory_order_relaxed)) stats->add_moves(1);
+    }
+
+public:
+    counted_value() = default;
+
+    counted_value(const T &initial) : value(initial) {}
+
+    counted_value(const counted_value &that) : value(that.value) { count(); }
+
+    counted_value(counted_value &&that) noexcept : value(std::move(that.value)) { count(); }
+
+    counted_value &operator=(const counted_value &that) {
+        value = that.value;
+        count();
+        return *this;
+    }
+
+    counted_value &operator=(counted_value &&that) noexcept {
+        value = std::move(that.value);
+        count();
+        return *this;
+    }
+
+    const T &get() const { return value; }
+
+    operator const T &() const { return value; }
+
+    friend bool operator<(const counted_value &a, const counted_value &b) { return a.value < b.value; }
+};
+
+#ifdef VE281P1_SORT_STATS
+
+inline uint64_t &sort_stats_depth() {
+    static thread_local uint64_t depth = 0;
+    return depth;
+}
+
+// counts one level of recursion for as long as it lives
+struct sort_depth_guard {
+    sort_depth_guard() {
+        uint64_t depth = ++sort_stats_depth();
+        if (sort_stats *stats = sort_stats::active().load(std::memory_order_relaxed)) stats->record_depth(depth);
+    }
+
+    sort_depth_guard(const sort_depth_guard &) = delete;
+
+    ~sort_depth_guard() { --sort_stats_depth(); }
+};
+
+inline void sort_stats_partition(size_t left, size_t right) {
+    if (sort_stats *stats = sort_stats::active().load(std::memory_order_relaxed)) stats->record_partition(left, right);
+}
+
+inline void sort_stats_allocation(size_t count) {
+    if (sort_stats *stats = sort_stats::active().load(std::memory_order_relaxed)) stats->add_allocations(count);
+}
+
+#define VE281P1_SORT_STATS_DEPTH() sort_depth_guard sort_depth_guard_instance
+#define VE281P1_SORT_STATS_PARTITION(left, right) sort_stats_partition((size_t)(left), (size_t)(right))
+#define VE281P1_SORT_STATS_ALLOCATION(count) sort_stats_allocation((size_t)(count))
+
+#else
+
+#define VE281P1_SORT_STATS_DEPTH() ((void)0)
+#define VE281P1_SORT_STATS_PARTITION(left, right) ((void)0)
+#define VE281P1_SORT_STATS_ALLOCATION(count) ((void)0)
+
+#endif //VE281P1_SORT_STATS
+
+#endif //VE281P1_SORT_STATS_HPP